@@ -1,11 +1,17 @@
 import time
 import serial
+from collections import deque
+from framing import FrameType, Parser, encode
+
+RECEIVE_TIMEOUT = 1.0
 
 class Communication:
     def __init__(self, param: str):
         port, speed = param.split(":")
         speed = int(speed)
         self.__serial = serial.Serial(port, speed)
+        self.__parser = Parser()
+        self.__frames = deque()
 
     
     def __del__(self):
@@ -16,28 +22,29 @@ class Communication:
             pass
 
 
-    def send(self, buffer: bytes) -> bool:
+    def send(self, frame_type: FrameType, payload: bytes) -> bool:
         status = False
 
         try:
             if self.__serial.is_open:
-                self.__serial.reset_output_buffer()
+                buffer = encode(frame_type, payload)
                 status = (len(buffer) == self.__serial.write(buffer))
         except:
             pass
 
         return status
 
-    def receive(self, size: int) -> bytes:
-        data = bytes()
+    def receive(self, timeout: float = RECEIVE_TIMEOUT) -> tuple[int, bytes] | None:
+        deadline = time.monotonic() + timeout
         try:
-            if self.__serial.is_open:
-                self.__serial.reset_input_buffer()
-                while self.__serial.in_waiting == 0:
-                    pass
-                time.sleep(0.1)
-                data = self.__serial.read(min(size, self.__serial.in_waiting))
+            while self.__serial.is_open and not self.__frames:
+                remaining = deadline - time.monotonic()
+                if remaining <= 0:
+                    break
+                self.__serial.timeout = remaining
+                data = self.__serial.read(max(1, self.__serial.in_waiting))
+                self.__frames.extend(self.__parser.feed(data))
         except:
             pass
 
-        return data
\ No newline at end of file
+        return self.__frames.popleft() if self.__frames else None
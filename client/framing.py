@@ -0,0 +1,61 @@
+import binascii
+import struct
+from enum import IntEnum
+
+# | SYNC 0xA5 0x5A | LENGTH (2) | TYPE (1) | PAYLOAD (LENGTH) | CRC (2) |
+# The CRC is CRC-16/CCITT-FALSE over LENGTH, TYPE and PAYLOAD.
+
+SYNC = b"\xA5\x5A"
+HEADER_SIZE = 5
+CRC_SIZE = 2
+CRC_INIT = 0xFFFF
+MAX_PAYLOAD = 1024
+
+class FrameType(IntEnum):
+    HANDSHAKE = 0x01
+    DATA = 0x02
+    PUSH = 0x03
+    RESUME = 0x04
+
+def encode(frame_type: FrameType, payload: bytes) -> bytes:
+    body = struct.pack(">HB", len(payload), frame_type) + payload
+    return SYNC + body + struct.pack(">H", binascii.crc_hqx(body, CRC_INIT))
+
+class Parser:
+    def __init__(self):
+        self.__buffer = bytearray()
+
+    def feed(self, data: bytes) -> list[tuple[int, bytes]]:
+        frames = []
+        self.__buffer += data
+
+        while True:
+            start = self.__buffer.find(SYNC)
+            if start < 0:
+                # Keep a trailing first sync byte, the second may still be on its way
+                keep = 1 if self.__buffer.endswith(SYNC[:1]) else 0
+                del self.__buffer[:len(self.__buffer) - keep]
+                break
+
+            del self.__buffer[:start]
+            if len(self.__buffer) < HEADER_SIZE:
+                break
+
+            length, frame_type = struct.unpack(">HB", self.__buffer[len(SYNC):HEADER_SIZE])
+            if length > MAX_PAYLOAD:
+                # Not a real header, search again from the next byte
+                del self.__buffer[:1]
+                continue
+
+            end = HEADER_SIZE + length
+            if len(self.__buffer) < end + CRC_SIZE:
+                break
+
+            crc = struct.unpack(">H", self.__buffer[end:end + CRC_SIZE])[0]
+            if crc == binascii.crc_hqx(bytes(self.__buffer[len(SYNC):end]), CRC_INIT):
+                frames.append((frame_type, bytes(self.__buffer[HEADER_SIZE:end])))
+                del self.__buffer[:end + CRC_SIZE]
+            else:
+                del self.__buffer[:1]
+
+        return frames
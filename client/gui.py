@@ -72,6 +72,12 @@ class Window(QWidget):
 
     def __handle_session(self):
         if not self.session_active:
+            (status, timestamp) = self.__session.resume_session()
+            if(status):
+                self.__open_session()
+                self.log_message(f"[{timestamp}]    Session resumed")
+                return
+
             (status, timestamp) = self.__session.establish_session()
             if(status):
                 self.__open_session()
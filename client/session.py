@@ -1,15 +1,33 @@
-from communication import Communication
+from communication import Communication, RECEIVE_TIMEOUT
+from collections import deque
+from framing import FrameType
 from mbedtls import cipher
 from enum import IntEnum
 import struct, random
 import time
 import hashlib
+import hmac
+
+PIPELINE_DEPTH = 16
+BATCH_MAX_COMMANDS = 16
+PIXELS_MAX_SIZE = 960
 
 class SessionRequest(IntEnum):
     CLOSE = 0
     GET_TEMP = 1
     TOGGLE_LED = 2
     TIMEOUT = 3
+    BATCH = 4
+    SUBSCRIBE_TEMP = 5
+    UNSUBSCRIBE_TEMP = 6
+    DUMP_SAMPLES = 7
+    SET_PIXELS = 8
+
+class CipherSuite(IntEnum):
+    AES_128_GCM = 1
+    AES_256_GCM = 2
+    CHACHA20_POLY1305 = 3
+    AES_128_CCM = 4
 
 class SessionStatus(IntEnum):
     EXPIRED = -1
@@ -17,8 +35,11 @@ class SessionStatus(IntEnum):
     OK = 1
 
 class Session:
-    def __init__(self, comparam: str, secret: str):
+    def __init__(self, comparam: str, secret: str, suites: tuple[CipherSuite, ...] = tuple(CipherSuite)):
+        """suites are the cipher suites offered in the handshake, the device picks one."""
         self.__com = Communication(comparam)
+        self.__suites = suites
+        self.__suite = CipherSuite.AES_256_GCM
 
         self.__session_id = bytes([0,0,0,0,0,0,0,0])
         self.__secret = hashlib.sha256(secret.encode()).digest()
@@ -32,6 +53,18 @@ class Session:
         self.__STATUS_SIZE = 1
         self.__LED_STATE_SIZE = 1
         self.__TEMPERATURE_SIZE = 4
+        self.__SEQ_SIZE = 4
+        self.__COUNTER_SIZE = 4
+        self.__CHUNK_HEADER_SIZE = 4
+        self.__SAMPLE_HEADER_SIZE = 10
+        self.__RESUMPTION_SECRET_SIZE = 32
+        self.__SUITE_SIZE = 1
+        self.__TICKET_SIZE = 73
+        self.__CLIENT_RAND_SIZE = 16
+
+        self.__seq = 0
+        self.__pushes = deque()
+        self.__ticket = None
 
     def establish_session(self) -> tuple[bool, str]:
         status = True 
@@ -47,29 +80,25 @@ class Session:
                 iv,
                 self.__session_id) 
             
-            cphr, tag = aes.encrypt(key + RAND)
+            cphr, tag = aes.encrypt(key + RAND + bytes([len(self.__suites)]) + bytes(self.__suites))
 
             message = iv + cphr + tag
-            status = self.__com.send(message)
+            status = self.__com.send(FrameType.HANDSHAKE, message)
 
             if status:
-                len_to_read = self.__AES_IV_SIZE + self.__SESSION_ID_SIZE + self.__TAG_SIZE
-                response = self.__com.receive(len_to_read)
+                len_to_read = self.__SUITE_SIZE + self.__AES_IV_SIZE + self.__SESSION_ID_SIZE + self.__TAG_SIZE
+                response = self.__receive(FrameType.HANDSHAKE)
 
-                if len(response) == len_to_read:
-                    offset = 0
+                if len(response) == len_to_read and response[0] in self.__suites:
+                    suite = CipherSuite(response[0])
+                    offset = self.__SUITE_SIZE
                     iv = response[offset : offset + self.__AES_IV_SIZE]
                     offset += self.__AES_IV_SIZE
                     cphr = response[offset: offset + self.__SESSION_ID_SIZE]
                     offset +=  self.__SESSION_ID_SIZE
                     tag = response[offset : offset + self.__TAG_SIZE]
                 
-                    aes = cipher.AES.new(
-                        key,
-                        cipher.MODE_GCM,
-                        iv,
-                        RAND) 
-                    
+                    aes = self.__aead(suite, key, iv, RAND + bytes([suite]))
                     session_id = aes.decrypt(cphr, tag)
 
                     timestamp_us = time.time_ns() // 1_000
@@ -77,20 +106,15 @@ class Session:
 
                     iv = random.randbytes(self.__AES_IV_SIZE)
 
-                    aes = cipher.AES.new(
-                        key,
-                        cipher.MODE_GCM,
-                        iv,
-                        session_id) 
-                    
+                    aes = self.__aead(suite, key, iv, session_id)
                     cphr, tag = aes.encrypt(timestamp_us_b)
 
                     message = iv + cphr + tag
-                    status = self.__com.send(message)
+                    status = self.__com.send(FrameType.HANDSHAKE, message)
 
                     if status:
                         len_to_read = self.__AES_IV_SIZE + self.__TIME_STAMP_SIZE + self.__TAG_SIZE
-                        response = self.__com.receive(self.__AES_IV_SIZE + self.__TIME_STAMP_SIZE + self.__TAG_SIZE)
+                        response = self.__receive(FrameType.HANDSHAKE)
 
                         if len(response) == len_to_read:
                             offset = 0 
@@ -100,17 +124,16 @@ class Session:
                             offset += self.__TIME_STAMP_SIZE
                             tag = response[offset : offset + self.__TAG_SIZE]
 
-                            aes = cipher.AES.new(
-                                key,
-                                cipher.MODE_GCM,
-                                iv,
-                                session_id) 
-                            
+                            aes = self.__aead(suite, key, iv, session_id)
                             timestamp_us_b_received = aes.decrypt(cphr, tag)
 
                             if(timestamp_us_b == timestamp_us_b_received):
                                 self.__session_id = session_id
+                                self.__suite = suite
                                 self.__key = key
+                                self.__derive_iv_bases(key)
+                                self.__seq = 0
+                                self.__pushes.clear()
                             else:
                                 status = False
 
@@ -125,201 +148,413 @@ class Session:
 
         return (status, readable_time)
 
+    def resume_session(self) -> tuple[bool, str]:
+        """Resume with the ticket from the last closed session in one round trip.
+
+        Returns (False, "") if there is no ticket or the device refused it,
+        in which case establish_session() is needed.
+        """
+        status = False
+        readable_time = ""
+
+        if self.__ticket is not None:
+            (secret, ticket, suite) = self.__ticket
+            # The device accepts a ticket only once
+            self.__ticket = None
+
+            client_rand = random.randbytes(self.__CLIENT_RAND_SIZE)
+            key = hmac.new(secret, client_rand, hashlib.sha256).digest()
+            iv = random.randbytes(self.__AES_IV_SIZE)
+
+            timestamp_us = time.time_ns() // 1_000
+            timestamp_us_b = struct.pack(">Q", timestamp_us)
+
+            try:
+                aes = self.__aead(suite, key, iv, client_rand)
+                cphr, tag = aes.encrypt(timestamp_us_b)
+
+                if self.__com.send(FrameType.RESUME, ticket + client_rand + iv + cphr + tag):
+                    response = self.__receive(FrameType.RESUME)
+
+                    if len(response) == self.__AES_IV_SIZE + self.__SESSION_ID_SIZE + self.__TIME_STAMP_SIZE + self.__TAG_SIZE:
+                        iv = response[:self.__AES_IV_SIZE]
+                        cphr = response[self.__AES_IV_SIZE:len(response) - self.__TAG_SIZE]
+                        tag = response[len(response) - self.__TAG_SIZE:]
+
+                        aes = self.__aead(suite, key, iv, client_rand)
+                        plaintext = aes.decrypt(cphr, tag)
+
+                        if plaintext[self.__SESSION_ID_SIZE:] == timestamp_us_b:
+                            self.__session_id = plaintext[:self.__SESSION_ID_SIZE]
+                            self.__suite = suite
+                            self.__key = key
+                            self.__derive_iv_bases(key)
+                            self.__seq = 0
+                            self.__pushes.clear()
+                            status = True
+                            readable_time = time.strftime("%Y-%m-%d %H:%M:%S", time.localtime(timestamp_us / 1_000_000))
+            except:
+                status = False
+
+        return (status, readable_time)
+
     def close_session(self) -> tuple[SessionStatus, str]:
-        self.__send_request(SessionRequest.CLOSE)
+        (status, timestamp_str, _) = self.pipeline([SessionRequest.CLOSE])[0]
 
-        receive_size = self.__AES_IV_SIZE + self.__STATUS_SIZE + self.__TIME_STAMP_SIZE + self.__TAG_SIZE
-        response = self.__com.receive(receive_size)
+        self.__session_id = bytes(self.__SESSION_ID_SIZE)
+        self.__key = None
 
-        if len(response) == receive_size:
-            offset = 0
-            iv = response[offset : offset + self.__AES_IV_SIZE]
-            offset += self.__AES_IV_SIZE
-            cphr = response[offset: offset + self.__STATUS_SIZE + self.__TIME_STAMP_SIZE]
-            offset += (self.__STATUS_SIZE + self.__TIME_STAMP_SIZE)
-            tag = response[offset : offset + self.__TAG_SIZE]
+        return (status, timestamp_str)
 
-            aes = cipher.AES.new(
-                self.__key, 
-                cipher.MODE_GCM,
-                iv,
-                self.__session_id 
-            )
-            plaintext = aes.decrypt(cphr, tag)
+    def toggle_led(self) -> tuple[SessionStatus, str, bool]:
+        return self.pipeline([SessionRequest.TOGGLE_LED])[0]
 
-            offset = 0
-            status = SessionStatus(struct.unpack(">b", plaintext[0:self.__STATUS_SIZE])[0])
-            offset += self.__STATUS_SIZE
-            time_us_received = struct.unpack(">Q", plaintext[offset: offset + self.__TIME_STAMP_SIZE])[0]
+    def get_temperature(self) -> tuple[SessionStatus, str, float]:
+        return self.pipeline([SessionRequest.GET_TEMP])[0]
 
-            timestamp_sec = time_us_received / 1_000_000
-            timestamp_str = time.strftime("%Y-%m-%d %H:%M:%S", time.localtime(timestamp_sec))
+    def subscribe_temperature(self, interval_ms: int, threshold: float = 0.0) -> tuple[SessionStatus, str]:
+        """Ask the device to push a temperature sample every interval_ms.
+
+        With a threshold, samples are only pushed when they differ from the
+        last pushed one by at least threshold degrees. Pushed samples are
+        collected with read_samples().
+        """
+        args = struct.pack(">HH", interval_ms, round(threshold * 100))
+        (status, timestamp_str, _) = self.__transact([(SessionRequest.SUBSCRIBE_TEMP, args)], PIPELINE_DEPTH)[0]
 
-            self.__session_id = bytes(self.__SESSION_ID_SIZE)
-            self.__key = None
-        
         return (status, timestamp_str)
 
+    def unsubscribe_temperature(self) -> tuple[SessionStatus, str]:
+        (status, timestamp_str, _) = self.pipeline([SessionRequest.UNSUBSCRIBE_TEMP])[0]
 
-    def toggle_led(self) -> tuple[SessionStatus, str, bool]:
-        if self.__send_request(SessionRequest.TOGGLE_LED):
-            response = self.__com.receive(self.__AES_IV_SIZE + self.__STATUS_SIZE + self.__TIME_STAMP_SIZE + self.__LED_STATE_SIZE + self.__TAG_SIZE)
-
-            if (len(response) == (self.__AES_IV_SIZE + self.__STATUS_SIZE + self.__TIME_STAMP_SIZE + self.__LED_STATE_SIZE + self.__TAG_SIZE)):
-                offset = 0
-                iv = response[offset : offset + self.__AES_IV_SIZE]
-                offset += self.__AES_IV_SIZE
-                cphr = response[offset: offset + self.__STATUS_SIZE + self.__TIME_STAMP_SIZE + self.__LED_STATE_SIZE]
-                offset += (self.__STATUS_SIZE + self.__TIME_STAMP_SIZE + self.__LED_STATE_SIZE)
-                tag = response[offset : offset + self.__TAG_SIZE]
-
-                aes = cipher.AES.new(
-                    self.__key,
-                    cipher.MODE_GCM,
-                    iv,
-                    self.__session_id 
-                )
-
-                plaintext = aes.decrypt(cphr, tag)
-
-                offset = 0
-                status = SessionStatus(struct.unpack(">b", plaintext[offset:self.__STATUS_SIZE])[0])
-                offset += self.__STATUS_SIZE
-                time_us_received = struct.unpack(">Q", plaintext[self.__STATUS_SIZE:offset + self.__TIME_STAMP_SIZE])[0]
-                offset += self.__TIME_STAMP_SIZE
-                led_state = plaintext[offset]
-
-                if status == SessionStatus.OK:
-                    timestamp_sec = time_us_received / 1_000_000
-                    timestamp_str = time.strftime("%Y-%m-%d %H:%M:%S", time.localtime(timestamp_sec))
-
-            elif (len(response) == (self.__AES_IV_SIZE + self.__STATUS_SIZE + self.__TIME_STAMP_SIZE + self.__TAG_SIZE)):
-                offset = 0
-                iv = response[offset : offset + self.__AES_IV_SIZE]
-                offset += self.__AES_IV_SIZE
-                cphr = response[offset: offset + self.__STATUS_SIZE + self.__TIME_STAMP_SIZE]
-                offset += (self.__STATUS_SIZE + self.__TIME_STAMP_SIZE)
-                tag = response[offset : offset + self.__TAG_SIZE]
-
-                aes = cipher.AES.new(
-                    self.__key,
-                    cipher.MODE_GCM,
-                    iv,
-                    self.__session_id 
-                )
-                plaintext = aes.decrypt(cphr, tag)
-
-                offset = 0
-                status = SessionStatus(struct.unpack(">b", plaintext[offset:offset + self.__STATUS_SIZE])[0])
-                offset += self.__STATUS_SIZE
-                time_us_received = struct.unpack(">Q", plaintext[offset:offset + self.__TIME_STAMP_SIZE])[0]
-
-                if status:
-                    timestamp_sec = time_us_received / 1_000_000
-                    timestamp_str = time.strftime("%Y-%m-%d %H:%M:%S", time.localtime(timestamp_sec))
-
-                led_state = 0
-                self.__session_id = bytes([0,0,0,0,0,0,0,0])
+        return (status, timestamp_str)
 
+    def read_samples(self, timeout: float = RECEIVE_TIMEOUT) -> list[tuple[SessionStatus, str, float]]:
+        """Return the pushed temperature samples received so far.
+
+        Waits up to timeout for a sample if none has arrived yet.
+        """
+        deadline = time.monotonic() + timeout
+
+        while not self.__pushes and time.monotonic() < deadline:
+            self.__receive(FrameType.PUSH, deadline - time.monotonic())
+
+        samples = list(self.__pushes)
+        self.__pushes.clear()
+
+        return samples
+
+    def dump_samples(self) -> tuple[SessionStatus, str, list[tuple[float, float]]]:
+        """Download the samples recorded by the device.
+
+        Returns (status, timestamp, samples) with samples as
+        (unix time in seconds, temperature) pairs, oldest first.
+        """
+        result = (SessionStatus.ERROR, "", [])
+        samples = []
+        seq = self.__send_request(SessionRequest.DUMP_SAMPLES)
+        index = 0
+        count = 1
+
+        while seq is not None and index < count:
+            response = self.__receive_response()
+            if response is None:
+                break
+
+            (response_seq, plaintext) = response
+            if response_seq != seq:
+                continue
+
+            (status, timestamp_str, data) = self.__decode_response(SessionRequest.DUMP_SAMPLES, plaintext)
+            if status != SessionStatus.OK or len(data) < self.__CHUNK_HEADER_SIZE:
+                break
+
+            (chunk_index, count) = struct.unpack(">HH", data[:self.__CHUNK_HEADER_SIZE])
+            if chunk_index != index:
+                break
+
+            samples += self.__decode_samples(data[self.__CHUNK_HEADER_SIZE:])
+            index += 1
+
+            if index == count:
+                result = (status, timestamp_str, samples)
+
+        return result
+
+    def set_pixels(self, start: int, pixels: list[tuple[int, int, int]]) -> tuple[SessionStatus, str]:
+        """Set the LED strip, from LED start onwards, to the given (r, g, b) pixels.
+
+        The frame is sent as a palette of its distinct colours followed by
+        (run length, palette index) pairs, so uniform stretches cost two
+        bytes. The encoded frame must fit in PIXELS_MAX_SIZE bytes.
+        """
+        palette = list(dict.fromkeys(pixels))
+        index_of = {color: index for (index, color) in enumerate(palette)}
+        runs = bytearray()
+        i = 0
+
+        while i < len(pixels):
+            run = 1
+            while i + run < len(pixels) and run < 255 and pixels[i + run] == pixels[i]:
+                run += 1
+            runs += struct.pack(">BB", run, index_of[pixels[i]])
+            i += run
+
+        args = struct.pack(">HB", start, len(palette)) + b"".join(bytes(color) for color in palette) + bytes(runs)
+        result = (SessionStatus.ERROR, "")
+
+        if 0 < len(palette) <= 255 and len(args) <= PIXELS_MAX_SIZE:
+            (status, timestamp_str, _) = self.__transact([(SessionRequest.SET_PIXELS, args)], PIPELINE_DEPTH)[0]
+            result = (status, timestamp_str)
+
+        return result
+
+    def pipeline(self, requests: list[SessionRequest], depth: int = PIPELINE_DEPTH) -> list[tuple[SessionStatus, str, object]]:
+        """Send the requests keeping up to depth of them in flight.
+
+        Responses are matched to requests by sequence number, so they may
+        arrive in any order. Results are returned in request order as
+        (status, timestamp, value), value being the temperature for
+        GET_TEMP, the LED state for TOGGLE_LED and None for CLOSE.
+        """
+        return self.__transact([(req, bytes()) for req in requests], depth)
+
+    def batch(self, commands: list[SessionRequest]) -> tuple[SessionStatus, str, list[tuple[SessionRequest, SessionStatus, object]]]:
+        """Run up to BATCH_MAX_COMMANDS GET_TEMP/TOGGLE_LED commands in one request.
+
+        The commands share a single encrypted request and response. Returns
+        (status, timestamp, results) where results holds one
+        (request, status, value) per command, in command order.
+        """
+        args = struct.pack(">B", len(commands)) + bytes(commands)
+        return self.__transact([(SessionRequest.BATCH, args)], PIPELINE_DEPTH)[0]
+
+    def __transact(self, requests: list[tuple[SessionRequest, bytes]], depth: int) -> list[tuple[SessionStatus, str, object]]:
+        results = [(SessionStatus.ERROR, "", self.__default_value(req)) for (req, _) in requests]
+        in_flight = {}
+        next_index = 0
+
+        while next_index < len(requests) or in_flight:
+            while next_index < len(requests) and len(in_flight) < depth:
+                seq = self.__send_request(*requests[next_index])
+                if seq is None:
+                    break
+                in_flight[seq] = next_index
+                next_index += 1
+
+            if not in_flight:
+                break
+
+            response = self.__receive_response()
+            if response is None:
+                break
+
+            seq, plaintext = response
+            if seq in in_flight:
+                index = in_flight.pop(seq)
+                results[index] = self.__decode_response(requests[index][0], plaintext)
+
+        return results
+
+    def __decode_response(self, req: SessionRequest, plaintext: bytes) -> tuple[SessionStatus, str, object]:
+        offset = 0
+        status = SessionStatus(struct.unpack(">b", plaintext[offset:offset + self.__STATUS_SIZE])[0])
+        offset += self.__STATUS_SIZE
+        time_us_received = struct.unpack(">Q", plaintext[offset:offset + self.__TIME_STAMP_SIZE])[0]
+        offset += self.__TIME_STAMP_SIZE
+
+        timestamp_sec = time_us_received / 1_000_000
+        timestamp_str = time.strftime("%Y-%m-%d %H:%M:%S", time.localtime(timestamp_sec))
+
+        value = self.__default_value(req)
+        data = plaintext[offset:]
+
+        if req == SessionRequest.CLOSE or status == SessionStatus.EXPIRED:
+            # The device closed the session, and hands out a ticket to resume it
+            self.__take_ticket(data)
+            if status == SessionStatus.EXPIRED:
+                self.__session_id = bytes(self.__SESSION_ID_SIZE)
+        elif req == SessionRequest.GET_TEMP and len(data) == self.__TEMPERATURE_SIZE:
+            value = struct.unpack("<f", data)[0]
+        elif req == SessionRequest.TOGGLE_LED and len(data) == self.__LED_STATE_SIZE:
+            value = data[0]
+        elif req == SessionRequest.BATCH and len(data) > 0:
+            value = self.__decode_batch(data)
+        elif req == SessionRequest.DUMP_SAMPLES and len(data) > 0:
+            value = data
+
+        return (status, timestamp_str, value)
+
+    def __take_ticket(self, data: bytes):
+        if len(data) == self.__RESUMPTION_SECRET_SIZE + self.__TICKET_SIZE:
+            # A resumed session keeps the suite of the session the ticket came from
+            self.__ticket = (data[:self.__RESUMPTION_SECRET_SIZE], data[self.__RESUMPTION_SECRET_SIZE:], self.__suite)
+
+    def __decode_batch(self, data: bytes) -> list[tuple[SessionRequest, SessionStatus, object]]:
+        results = []
+        count = data[0]
+        offset = 1
+
+        for _ in range(count):
+            req = SessionRequest(data[offset])
+            status = SessionStatus(struct.unpack(">b", data[offset + 1:offset + 2])[0])
+            offset += 2
+
+            if req == SessionRequest.GET_TEMP:
+                value = struct.unpack("<f", data[offset:offset + self.__TEMPERATURE_SIZE])[0]
+                offset += self.__TEMPERATURE_SIZE
             else:
-                status = SessionStatus.ERROR
-                timestamp_str = ""
-                led_state = 0
-        
-        return (status, timestamp_str, led_state)
-        
+                value = data[offset]
+                offset += self.__LED_STATE_SIZE
 
-    def get_temperature(self) -> tuple[SessionStatus, str, float]:
-        status = self.__send_request(SessionRequest.GET_TEMP)
-        if status:
-
-            response = self.__com.receive(self.__AES_IV_SIZE + self.__STATUS_SIZE + self.__TIME_STAMP_SIZE + self.__TEMPERATURE_SIZE + self.__TAG_SIZE)
-
-            if(len(response) == self.__AES_IV_SIZE + self.__STATUS_SIZE + self.__TIME_STAMP_SIZE + self.__TEMPERATURE_SIZE + self.__TAG_SIZE):
-                offset = 0
-                iv = response[offset : offset + self.__AES_IV_SIZE]
-                offset += self.__AES_IV_SIZE
-                cphr = response[offset: offset + self.__STATUS_SIZE + self.__TIME_STAMP_SIZE + self.__TEMPERATURE_SIZE]
-                offset += (self.__STATUS_SIZE + self.__TIME_STAMP_SIZE + self.__TEMPERATURE_SIZE)
-                tag = response[offset : offset + self.__TAG_SIZE]
-
-                aes = cipher.AES.new(
-                    self.__key, 
-                    cipher.MODE_GCM,
-                    iv, self.__session_id
-                )
-                plaintext = aes.decrypt(cphr, tag)
-
-                offset = 0
-                status = SessionStatus(struct.unpack(">b", plaintext[offset:self.__STATUS_SIZE])[0])
-                offset += self.__STATUS_SIZE
-                time_us_received = struct.unpack(">Q", plaintext[offset: offset + self.__TIME_STAMP_SIZE])[0]
-                offset += self.__TIME_STAMP_SIZE
-                temp_b = plaintext[offset: offset + self.__TEMPERATURE_SIZE]
-
-                temperature = struct.unpack("<f", temp_b)[0]
-                timestamp_sec = time_us_received / 1_000_000
-                timestamp_str = time.strftime("%Y-%m-%d %H:%M:%S", time.localtime(timestamp_sec))
-
-            elif(len(response) == self.__AES_IV_SIZE + self.__STATUS_SIZE + self.__TIME_STAMP_SIZE + self.__TAG_SIZE):
-                offset = 0
-                iv = response[offset : offset + self.__AES_IV_SIZE]
-                offset += self.__AES_IV_SIZE
-                cphr = response[offset: offset + self.__STATUS_SIZE + self.__TIME_STAMP_SIZE]
-                offset += (self.__STATUS_SIZE + self.__TIME_STAMP_SIZE)
-                tag = response[offset : offset + self.__TAG_SIZE]
-
-                aes = cipher.AES.new(
-                    self.__key, 
-                    cipher.MODE_GCM,
-                    iv, self.__session_id
-                )
-                plaintext = aes.decrypt(cphr, tag)
-
-                offset = 0
-                status = SessionStatus(struct.unpack(">b", plaintext[offset:self.__STATUS_SIZE])[0])
-                offset += self.__STATUS_SIZE
-                time_us_received = struct.unpack(">Q", plaintext[offset: offset + self.__TIME_STAMP_SIZE])[0]
-                timestamp_sec = time_us_received / 1_000_000
-                timestamp_str = time.strftime("%Y-%m-%d %H:%M:%S", time.localtime(timestamp_sec))
-
-                temperature = 0
-                self.__session_id = bytes([0,0,0,0,0,0,0,0])
+            results.append((req, status, value))
 
-            else:
-                status = SessionStatus.ERROR
-                timestamp_str = ""
-                temperature = 0
-                
+        return results
+
+    def __decode_samples(self, blocks: bytes) -> list[tuple[float, float]]:
+        # Blocks: [len][time ms (8)][temp centi (2)] then (varint dt, zigzag varint dtemp) pairs
+        samples = []
+        offset = 0
+
+        while offset < len(blocks):
+            end = offset + 1 + blocks[offset]
+            (time_ms, temp) = struct.unpack(">Qh", blocks[offset + 1:offset + 1 + self.__SAMPLE_HEADER_SIZE])
+            samples.append((time_ms / 1000, temp / 100))
+            offset += 1 + self.__SAMPLE_HEADER_SIZE
 
-        return (status, timestamp_str, temperature)
-    
+            while offset < end:
+                (dt, offset) = self.__read_varint(blocks, offset)
+                (dtemp, offset) = self.__read_varint(blocks, offset)
+                time_ms += dt
+                temp += (dtemp >> 1) ^ -(dtemp & 1)
+                samples.append((time_ms / 1000, temp / 100))
 
-    
-    def __send_request(self, req: SessionRequest) -> bool:
-        status = True
+        return samples
+
+    def __read_varint(self, data: bytes, offset: int) -> tuple[int, int]:
+        value = 0
+        shift = 0
+
+        while True:
+            byte = data[offset]
+            offset += 1
+            value |= (byte & 0x7F) << shift
+            shift += 7
+            if byte & 0x80 == 0:
+                break
+
+        return (value, offset)
+
+    def __default_value(self, req: SessionRequest) -> object:
+        value = None
+
+        if req == SessionRequest.GET_TEMP:
+            value = 0.0
+        elif req == SessionRequest.TOGGLE_LED:
+            value = 0
+        elif req == SessionRequest.BATCH:
+            value = []
+        elif req == SessionRequest.DUMP_SAMPLES:
+            value = bytes()
+
+        return value
+
+    def __send_request(self, req: SessionRequest, args: bytes = bytes()) -> int | None:
+        seq = None
 
         timestamp_us = time.time_ns() // 1_000
         timestamp_b = struct.pack(">Q", timestamp_us)
 
-        iv = random.randbytes(self.__AES_IV_SIZE)
+        iv = self.__data_iv(self.__iv_c2d, self.__seq)
+        seq_b = struct.pack(">I", self.__seq)
+
+        packet = None
 
         try:
-            aes = cipher.AES.new(
-                self.__key,
-                cipher.MODE_GCM,
-                iv,
-                self.__session_id  
-            )
+            aes = self.__aead(self.__suite, self.__key, iv, self.__session_id + seq_b)
 
-            payload = struct.pack(">B", req) + timestamp_b
+            payload = struct.pack(">B", req) + timestamp_b + args
             cphr, tag = aes.encrypt(payload)
 
-            packet = iv + cphr + tag
+            packet = seq_b + cphr + tag
+        except (TypeError, ValueError):
+            pass
 
-            if not self.__com.send(packet):
-                status = False
-        except:
-            status = False
-        
-        return status
\ No newline at end of file
+        if packet is not None:
+            # The nonce is spent once used, even if the frame never fully
+            # leaves, as part of it may already have reached the device
+            sent_seq = self.__seq
+            self.__seq = (self.__seq + 1) & 0xFFFFFFFF
+
+            if self.__com.send(FrameType.DATA, packet):
+                seq = sent_seq
+
+        return seq
+
+    def __aead(self, suite: CipherSuite, key: bytes, iv: bytes, ad: bytes):
+        # Suites with a 16 byte key use the first half of the key material
+        if suite == CipherSuite.CHACHA20_POLY1305:
+            aead = cipher.CHACHA20_POLY1305.new(key, cipher.MODE_CHACHAPOLY, iv, ad)
+        elif suite == CipherSuite.AES_128_CCM:
+            aead = cipher.AES.new(key[:16], cipher.MODE_CCM, iv, ad)
+        elif suite == CipherSuite.AES_128_GCM:
+            aead = cipher.AES.new(key[:16], cipher.MODE_GCM, iv, ad)
+        else:
+            aead = cipher.AES.new(key, cipher.MODE_GCM, iv, ad)
+
+        return aead
+
+    def __derive_iv_bases(self, key: bytes):
+        # Data frames carry no IV, the nonce is a per-direction base XOR a counter
+        self.__iv_c2d = hmac.new(key, b"c2d iv", hashlib.sha256).digest()[:self.__AES_IV_SIZE]
+        self.__iv_d2c = hmac.new(key, b"d2c iv", hashlib.sha256).digest()[:self.__AES_IV_SIZE]
+
+    def __data_iv(self, base: bytes, counter: int) -> bytes:
+        tail = int.from_bytes(base[-self.__COUNTER_SIZE:], "big") ^ counter
+        return base[:-self.__COUNTER_SIZE] + tail.to_bytes(self.__COUNTER_SIZE, "big")
+
+    def __receive_response(self) -> tuple[int, bytes] | None:
+        return self.__open(self.__receive(FrameType.DATA))
+
+    def __open(self, data: bytes) -> tuple[int, bytes] | None:
+        response = None
+
+        if len(data) >= self.__COUNTER_SIZE + self.__SEQ_SIZE + self.__STATUS_SIZE + self.__TIME_STAMP_SIZE + self.__TAG_SIZE:
+            offset = 0
+            counter = struct.unpack(">I", data[offset:offset + self.__COUNTER_SIZE])[0]
+            offset += self.__COUNTER_SIZE
+            seq_b = data[offset:offset + self.__SEQ_SIZE]
+            offset += self.__SEQ_SIZE
+            iv = self.__data_iv(self.__iv_d2c, counter)
+            cphr = data[offset:len(data) - self.__TAG_SIZE]
+            tag = data[len(data) - self.__TAG_SIZE:]
+
+            try:
+                aes = self.__aead(self.__suite, self.__key, iv, self.__session_id + seq_b)
+                response = (struct.unpack(">I", seq_b)[0], aes.decrypt(cphr, tag))
+            except:
+                pass
+
+        return response
+
+    def __receive(self, frame_type: FrameType, timeout: float = RECEIVE_TIMEOUT) -> bytes:
+        data = bytes()
+        frame = self.__com.receive(timeout)
+
+        # Pushes may arrive between any two frames, keep them for read_samples()
+        while frame is not None and frame[0] == FrameType.PUSH:
+            self.__stash_push(frame[1])
+            frame = None if frame_type == FrameType.PUSH else self.__com.receive(timeout)
+
+        if frame is not None and frame[0] == frame_type:
+            data = frame[1]
+
+        return data
+
+    def __stash_push(self, data: bytes):
+        push = self.__open(data)
+
+        if push is not None:
+            (_, plaintext) = push
+            if len(plaintext) == self.__STATUS_SIZE + self.__TIME_STAMP_SIZE + self.__TEMPERATURE_SIZE:
+                self.__pushes.append(self.__decode_response(SessionRequest.GET_TEMP, plaintext))
\ No newline at end of file
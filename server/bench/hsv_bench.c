@@ -0,0 +1,168 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "led_strip.h"
+#include "driver/spi_master.h"
+
+/* Times a rainbow frame written with the batched integer HSV conversion
+ * against the float conversion it replaced, which went through
+ * led_strip_set_pixel() once per pixel, and checks both encode the same. */
+
+#define LEDS 300
+#define FRAMES 5000
+
+static void reference_set_pixel_hsv(led_strip_handle_t strip, uint32_t index, uint16_t hue, uint8_t saturation, uint8_t value);
+static double now_s(void);
+
+// led_strip_set_pixel_hsv() before the integer conversion
+static void reference_set_pixel_hsv(led_strip_handle_t strip, uint32_t index, uint16_t hue, uint8_t saturation, uint8_t value)
+{
+    uint32_t red = 0;
+    uint32_t green = 0;
+    uint32_t blue = 0;
+
+    uint32_t rgb_max = value;
+    uint32_t rgb_min = rgb_max * (255 - saturation) / 255.0f;
+
+    uint32_t i = hue / 60;
+    uint32_t diff = hue % 60;
+
+    uint32_t rgb_adj = (rgb_max - rgb_min) * diff / 60;
+
+    switch (i)
+    {
+    case 0:
+        red = rgb_max;
+        green = rgb_min + rgb_adj;
+        blue = rgb_min;
+        break;
+    case 1:
+        red = rgb_max - rgb_adj;
+        green = rgb_max;
+        blue = rgb_min;
+        break;
+    case 2:
+        red = rgb_min;
+        green = rgb_max;
+        blue = rgb_min + rgb_adj;
+        break;
+    case 3:
+        red = rgb_min;
+        green = rgb_max - rgb_adj;
+        blue = rgb_max;
+        break;
+    case 4:
+        red = rgb_min + rgb_adj;
+        green = rgb_min;
+        blue = rgb_max;
+        break;
+    default:
+        red = rgb_max;
+        green = rgb_min;
+        blue = rgb_max - rgb_adj;
+        break;
+    }
+
+    (void)led_strip_set_pixel(strip, index, red, green, blue);
+}
+
+static double now_s(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int main(void)
+{
+    static led_strip_hsv_t hsv[LEDS];
+    static uint8_t expected[LEDS * 3 * 3];
+    led_strip_handle_t strip = NULL;
+    const uint8_t *tx = NULL;
+    size_t tx_len = 0;
+
+    led_strip_config_t strip_config = {
+        .strip_gpio_num = 8,
+        .max_leds = LEDS,
+        .led_model = LED_MODEL_WS2812,
+    };
+    led_strip_spi_config_t spi_config = {
+        .spi_bus = SPI2_HOST,
+    };
+
+    if (ESP_OK != led_strip_new_spi_device(&strip_config, &spi_config, &strip))
+    {
+        printf("cannot create strip\n");
+        return EXIT_FAILURE;
+    }
+
+    // Every hue, saturation and value once, including hues past 360
+    for (uint32_t h = 0; h < 400; h++)
+    {
+        for (uint32_t s = 0; s < 256; s++)
+        {
+            for (uint32_t v = 0; v < 256; v++)
+            {
+                const led_strip_hsv_t one = {.hue = h, .saturation = s, .value = v};
+                uint8_t rgb[3];
+                led_strip_hsv_to_rgb(&one, rgb, 1);
+                reference_set_pixel_hsv(strip, 0, h, s, v);
+                (void)led_strip_set_pixels(strip, 1, 1, rgb);
+                (void)led_strip_refresh(strip);
+                tx = spi_stub_last_tx(&tx_len);
+                if (0 != memcmp(tx, tx + 9, 9))
+                {
+                    printf("mismatch at h=%u s=%u v=%u\n", h, s, v);
+                    return EXIT_FAILURE;
+                }
+            }
+        }
+    }
+
+    // A rainbow sweeping along the strip
+    for (uint32_t i = 0; i < LEDS; i++)
+    {
+        hsv[i] = (led_strip_hsv_t){.hue = (i * 360) / LEDS, .saturation = 200 + (i % 56), .value = 64 + (i % 192)};
+    }
+
+    double start = now_s();
+    for (uint32_t frame = 0; frame < FRAMES; frame++)
+    {
+        for (uint32_t i = 0; i < LEDS; i++)
+        {
+            reference_set_pixel_hsv(strip, i, hsv[i].hue, hsv[i].saturation, hsv[i].value);
+        }
+    }
+    double reference = now_s() - start;
+
+    (void)led_strip_refresh(strip);
+    tx = spi_stub_last_tx(&tx_len);
+    memcpy(expected, tx, sizeof(expected));
+    (void)led_strip_clear(strip);
+
+    start = now_s();
+    for (uint32_t frame = 0; frame < FRAMES; frame++)
+    {
+        (void)led_strip_set_pixels_hsv(strip, 0, LEDS, hsv);
+    }
+    double batched = now_s() - start;
+
+    (void)led_strip_refresh(strip);
+    tx = spi_stub_last_tx(&tx_len);
+    int status = (0 == memcmp(expected, tx, sizeof(expected))) ? EXIT_SUCCESS : EXIT_FAILURE;
+    if (EXIT_SUCCESS != status)
+    {
+        printf("frames differ\n");
+    }
+
+    double pixels = (double)LEDS * FRAMES;
+    printf("per pixel, float   : %6.2f ns/pixel\n", reference * 1e9 / pixels);
+    printf("batched, integer   : %6.2f ns/pixel\n", batched * 1e9 / pixels);
+    printf("speed-up           : %6.2fx\n", reference / batched);
+
+    (void)led_strip_del(strip);
+
+    return status;
+}
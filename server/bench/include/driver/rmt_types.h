@@ -0,0 +1,11 @@
+#ifndef DRIVER_RMT_TYPES_H
+#define DRIVER_RMT_TYPES_H
+
+/* Only the types named by led_strip_rmt.h, the RMT backend is not built. */
+
+typedef enum
+{
+    RMT_CLK_SRC_DEFAULT = 0,
+} rmt_clock_source_t;
+
+#endif
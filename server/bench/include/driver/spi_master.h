@@ -0,0 +1,84 @@
+#ifndef DRIVER_SPI_MASTER_H
+#define DRIVER_SPI_MASTER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+
+/* Stand-in for the SPI master driver: transfers complete immediately and
+ * the last queued buffer is kept so that benchmarks can compare frames. */
+
+#define MALLOC_CAP_DEFAULT (1 << 0)
+#define MALLOC_CAP_INTERNAL (1 << 1)
+#define MALLOC_CAP_DMA (1 << 2)
+
+typedef enum
+{
+    SPI1_HOST = 0,
+    SPI2_HOST = 1,
+} spi_host_device_t;
+
+typedef enum
+{
+    SPI_CLK_SRC_DEFAULT = 0,
+} spi_clock_source_t;
+
+typedef enum
+{
+    SPI_DMA_DISABLED = 0,
+    SPI_DMA_CH_AUTO = 3,
+} spi_dma_chan_t;
+
+typedef struct spi_device_t *spi_device_handle_t;
+
+typedef struct
+{
+    uint32_t flags;
+    size_t length;
+    size_t rxlength;
+    void *user;
+    const void *tx_buffer;
+    void *rx_buffer;
+} spi_transaction_t;
+
+typedef struct
+{
+    int mosi_io_num;
+    int miso_io_num;
+    int sclk_io_num;
+    int quadwp_io_num;
+    int quadhd_io_num;
+    int max_transfer_sz;
+} spi_bus_config_t;
+
+typedef struct
+{
+    spi_clock_source_t clock_source;
+    uint8_t command_bits;
+    uint8_t address_bits;
+    uint8_t dummy_bits;
+    uint8_t mode;
+    int clock_speed_hz;
+    int spics_io_num;
+    int queue_size;
+} spi_device_interface_config_t;
+
+void *heap_caps_calloc(size_t n, size_t size, uint32_t caps);
+
+esp_err_t spi_bus_initialize(spi_host_device_t host, const spi_bus_config_t *config, spi_dma_chan_t dma);
+esp_err_t spi_bus_free(spi_host_device_t host);
+esp_err_t spi_bus_add_device(spi_host_device_t host, const spi_device_interface_config_t *config, spi_device_handle_t *handle);
+esp_err_t spi_bus_remove_device(spi_device_handle_t handle);
+esp_err_t spi_device_get_actual_freq(spi_device_handle_t handle, int *freq_khz);
+esp_err_t spi_device_queue_trans(spi_device_handle_t handle, spi_transaction_t *trans, TickType_t ticks_to_wait);
+esp_err_t spi_device_get_trans_result(spi_device_handle_t handle, spi_transaction_t **trans, TickType_t ticks_to_wait);
+esp_err_t spi_device_transmit(spi_device_handle_t handle, spi_transaction_t *trans);
+
+/**
+ * @brief Get the buffer and length in bytes of the last queued transfer.
+ */
+const uint8_t *spi_stub_last_tx(size_t *len);
+
+#endif
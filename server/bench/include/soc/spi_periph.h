@@ -0,0 +1,15 @@
+#ifndef SOC_SPI_PERIPH_H
+#define SOC_SPI_PERIPH_H
+
+#include <stdint.h>
+
+#define BIT(nr) (1UL << (nr))
+
+typedef struct
+{
+    uint32_t spid_out;
+} spi_signal_conn_t;
+
+extern const spi_signal_conn_t spi_periph_signal[3];
+
+#endif
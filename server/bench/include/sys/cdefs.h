@@ -0,0 +1,12 @@
+#ifndef BENCH_SYS_CDEFS_H
+#define BENCH_SYS_CDEFS_H
+
+#include_next <sys/cdefs.h>
+#include <stddef.h>
+
+/* Provided by the newlib sys/cdefs.h of ESP-IDF, missing from glibc. */
+#ifndef __containerof
+#define __containerof(ptr, type, member) ((type *)((char *)(ptr) - offsetof(type, member)))
+#endif
+
+#endif
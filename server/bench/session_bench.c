@@ -0,0 +1,129 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "session.h"
+#include "session_client.h"
+#include "transport_loopback.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+/* Runs the firmware session in a task behind the loopback transport and
+ * drives it from a client written against the same framing and crypto,
+ * timing handshakes and GET_TEMP round trips for every built-in suite.
+ * No link sits in between, so the numbers are the cost of the protocol
+ * and its crypto alone. */
+
+#define HANDSHAKES 200
+#define REQUESTS 20000
+#define PIPELINE_DEPTH 16
+
+#define TIME_STAMP_SIZE 8
+#define TEMP_RESPONSE_SIZE (1 + TIME_STAMP_SIZE + sizeof(float))
+
+static void device_task(void *param);
+static double now_s(void);
+
+static transport_loopback_t loopback;
+
+static void device_task(void *param)
+{
+    (void)param;
+
+    while (true)
+    {
+        if (!session_is_active())
+        {
+            (void)session_establish();
+        }
+        else
+        {
+            switch (session_get_request())
+            {
+            case GET_TEMP:
+                (void)session_send_temperature(true, 24.5f);
+                break;
+
+            case TOGGLE_LED:
+                (void)session_send_toggle_led(true, 1);
+                break;
+
+            default:
+                break;
+            }
+        }
+    }
+}
+
+static double now_s(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+int main(void)
+{
+    bool status = false;
+    session_client_t client;
+
+    if (transport_loopback_init(&loopback) && session_init(&loopback.device.transport, "") &&
+        session_client_init(&client, &loopback.client.transport, HSECRET) &&
+        (pdPASS == xTaskCreate(device_task, "device", 8192, NULL, 0, NULL)))
+    {
+        status = true;
+        printf("%-18s %14s %14s %14s\n", "suite", "handshake us", "round trip us", "pipelined/s");
+    }
+
+    for (int suite = 1; status && (suite <= SESSION_SUITE_COUNT); suite++)
+    {
+        if (NULL != session_crypto_suite_name((session_suite_t)suite))
+        {
+            double start = now_s();
+            for (int i = 0; status && (i < HANDSHAKES); i++)
+            {
+                status = session_client_establish(&client, (session_suite_t)suite) && session_client_close(&client);
+            }
+            double handshake = (now_s() - start) / HANDSHAKES;
+
+            status = status && session_client_establish(&client, (session_suite_t)suite);
+            start = now_s();
+            for (int i = 0; status && (i < REQUESTS); i++)
+            {
+                status = session_client_send(&client, GET_TEMP, NULL, 0) &&
+                         session_client_receive(&client, TEMP_RESPONSE_SIZE);
+            }
+            double round_trip = (now_s() - start) / REQUESTS;
+
+            // Keep PIPELINE_DEPTH requests in flight, as Session.pipeline() does
+            start = now_s();
+            int sent = 0;
+            int received = 0;
+            while (status && (received < REQUESTS))
+            {
+                if ((sent < REQUESTS) && (sent - received < PIPELINE_DEPTH))
+                {
+                    status = session_client_send(&client, GET_TEMP, NULL, 0);
+                    sent++;
+                }
+                else
+                {
+                    status = session_client_receive(&client, TEMP_RESPONSE_SIZE);
+                    received++;
+                }
+            }
+            double pipelined = REQUESTS / (now_s() - start);
+
+            status = status && session_client_close(&client);
+            printf("%-18s %14.1f %14.2f %14.0f\n", session_crypto_suite_name((session_suite_t)suite),
+                   handshake * 1e6, round_trip * 1e6, pipelined);
+        }
+    }
+
+    if (!status)
+    {
+        printf("session benchmark failed\n");
+    }
+
+    return status ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,106 @@
+#include <stdlib.h>
+#include "esp_rom_gpio.h"
+#include "soc/spi_periph.h"
+#include "driver/spi_master.h"
+
+const spi_signal_conn_t spi_periph_signal[3];
+
+static const uint8_t *last_tx;
+static size_t last_tx_len;
+static spi_transaction_t *pending;
+
+void esp_rom_gpio_connect_out_signal(uint32_t gpio_num, uint32_t signal_idx, bool out_inv, bool oen_inv)
+{
+    (void)gpio_num;
+    (void)signal_idx;
+    (void)out_inv;
+    (void)oen_inv;
+}
+
+void esp_rom_delay_us(uint32_t us)
+{
+    (void)us;
+}
+
+void *heap_caps_calloc(size_t n, size_t size, uint32_t caps)
+{
+    (void)caps;
+
+    return calloc(n, size);
+}
+
+esp_err_t spi_bus_initialize(spi_host_device_t host, const spi_bus_config_t *config, spi_dma_chan_t dma)
+{
+    (void)host;
+    (void)config;
+    (void)dma;
+
+    return ESP_OK;
+}
+
+esp_err_t spi_bus_free(spi_host_device_t host)
+{
+    (void)host;
+
+    return ESP_OK;
+}
+
+esp_err_t spi_bus_add_device(spi_host_device_t host, const spi_device_interface_config_t *config, spi_device_handle_t *handle)
+{
+    (void)host;
+    (void)config;
+    *handle = (spi_device_handle_t)&pending;
+
+    return ESP_OK;
+}
+
+esp_err_t spi_bus_remove_device(spi_device_handle_t handle)
+{
+    (void)handle;
+
+    return ESP_OK;
+}
+
+esp_err_t spi_device_get_actual_freq(spi_device_handle_t handle, int *freq_khz)
+{
+    (void)handle;
+    *freq_khz = 2500;
+
+    return ESP_OK;
+}
+
+esp_err_t spi_device_queue_trans(spi_device_handle_t handle, spi_transaction_t *trans, TickType_t ticks_to_wait)
+{
+    (void)handle;
+    (void)ticks_to_wait;
+    last_tx = trans->tx_buffer;
+    last_tx_len = trans->length / 8;
+    pending = trans;
+
+    return ESP_OK;
+}
+
+esp_err_t spi_device_get_trans_result(spi_device_handle_t handle, spi_transaction_t **trans, TickType_t ticks_to_wait)
+{
+    (void)handle;
+    (void)ticks_to_wait;
+    *trans = pending;
+    pending = NULL;
+
+    return (NULL != *trans) ? ESP_OK : ESP_ERR_TIMEOUT;
+}
+
+esp_err_t spi_device_transmit(spi_device_handle_t handle, spi_transaction_t *trans)
+{
+    spi_transaction_t *done = NULL;
+    esp_err_t err = spi_device_queue_trans(handle, trans, portMAX_DELAY);
+
+    return (ESP_OK == err) ? spi_device_get_trans_result(handle, &done, portMAX_DELAY) : err;
+}
+
+const uint8_t *spi_stub_last_tx(size_t *len)
+{
+    *len = last_tx_len;
+
+    return last_tx;
+}
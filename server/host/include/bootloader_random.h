@@ -0,0 +1,8 @@
+#ifndef BOOTLOADER_RANDOM_H
+#define BOOTLOADER_RANDOM_H
+
+/* The host entropy source is always available, both calls are no-ops. */
+static inline void bootloader_random_enable(void) {}
+static inline void bootloader_random_disable(void) {}
+
+#endif
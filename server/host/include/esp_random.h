@@ -0,0 +1,22 @@
+#ifndef ESP_RANDOM_H
+#define ESP_RANDOM_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Get one random 32-bit word from the host entropy source.
+ *
+ * @return uint32_t Random value
+ */
+uint32_t esp_random(void);
+
+/**
+ * @brief Fill a buffer with random bytes from the host entropy source.
+ *
+ * @param buf Pointer to destination buffer
+ * @param len Number of bytes to fill
+ */
+void esp_fill_random(void *buf, size_t len);
+
+#endif
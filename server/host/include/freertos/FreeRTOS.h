@@ -0,0 +1,23 @@
+#ifndef FREERTOS_H
+#define FREERTOS_H
+
+#include <stdint.h>
+
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+
+/* Same tick rate as CONFIG_FREERTOS_HZ in the target sdkconfig. */
+#define configTICK_RATE_HZ 100
+
+#define portMAX_DELAY ((TickType_t)0xffffffffUL)
+
+#define pdFALSE ((BaseType_t)0)
+#define pdTRUE ((BaseType_t)1)
+#define pdFAIL pdFALSE
+#define pdPASS pdTRUE
+
+#define pdMS_TO_TICKS(ms) ((TickType_t)(((TickType_t)(ms) * (TickType_t)configTICK_RATE_HZ) / (TickType_t)1000U))
+#define pdTICKS_TO_MS(ticks) ((TickType_t)(((TickType_t)(ticks) * (TickType_t)1000U) / (TickType_t)configTICK_RATE_HZ))
+
+#endif
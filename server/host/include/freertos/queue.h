@@ -0,0 +1,28 @@
+#ifndef FREERTOS_QUEUE_H
+#define FREERTOS_QUEUE_H
+
+#include "FreeRTOS.h"
+
+typedef struct host_queue *QueueHandle_t;
+
+/**
+ * @brief Create a queue holding up to length items of item_size bytes.
+ */
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size);
+
+/**
+ * @brief Copy an item to the back of the queue, waiting up to ticks for space.
+ */
+BaseType_t xQueueSend(QueueHandle_t queue, const void *item, TickType_t ticks);
+
+/**
+ * @brief Write an item to a queue of length one, replacing any queued item.
+ */
+BaseType_t xQueueOverwrite(QueueHandle_t queue, const void *item);
+
+/**
+ * @brief Take the item at the front of the queue, waiting up to ticks for one.
+ */
+BaseType_t xQueueReceive(QueueHandle_t queue, void *item, TickType_t ticks);
+
+#endif
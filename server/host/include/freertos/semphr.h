@@ -0,0 +1,32 @@
+#ifndef FREERTOS_SEMPHR_H
+#define FREERTOS_SEMPHR_H
+
+#include "FreeRTOS.h"
+
+typedef struct host_semaphore *SemaphoreHandle_t;
+
+/**
+ * @brief Create a mutex. The host always waits for the mutex in take.
+ */
+SemaphoreHandle_t xSemaphoreCreateMutex(void);
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t mutex, TickType_t ticks);
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t mutex);
+
+/**
+ * @brief Create a mutex that may be taken again by the task holding it.
+ */
+SemaphoreHandle_t xSemaphoreCreateRecursiveMutex(void);
+
+/**
+ * @brief Take a recursive mutex. The host always waits for the mutex.
+ */
+BaseType_t xSemaphoreTakeRecursive(SemaphoreHandle_t mutex, TickType_t ticks);
+
+/**
+ * @brief Give back one level of a recursive mutex.
+ */
+BaseType_t xSemaphoreGiveRecursive(SemaphoreHandle_t mutex);
+
+#endif
@@ -0,0 +1,28 @@
+#ifndef FREERTOS_TASK_H
+#define FREERTOS_TASK_H
+
+#include "FreeRTOS.h"
+
+typedef void (*TaskFunction_t)(void *);
+typedef struct host_task *TaskHandle_t;
+
+/**
+ * @brief Create a task, backed by a detached POSIX thread on the host.
+ *
+ * The stack depth and priority are accepted for source compatibility
+ * and otherwise ignored.
+ */
+BaseType_t xTaskCreate(TaskFunction_t task, const char *name, uint32_t stack_depth,
+                       void *param, UBaseType_t priority, TaskHandle_t *ret_handle);
+
+/**
+ * @brief Block the calling thread for the given number of ticks.
+ */
+void vTaskDelay(TickType_t ticks);
+
+/**
+ * @brief Get the number of ticks since the process started.
+ */
+TickType_t xTaskGetTickCount(void);
+
+#endif
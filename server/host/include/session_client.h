@@ -0,0 +1,93 @@
+#ifndef SESSION_CLIENT_H
+#define SESSION_CLIENT_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "session.h"
+#include "session_crypto.h"
+#include "framing.h"
+#include "transport.h"
+
+/*
+ * The client of client/session.py in C, for host programs that drive the
+ * firmware session from another task, e.g. over the loopback transport.
+ * It only covers what those programs need: the full handshake offering a
+ * single suite, data requests and their status, and close.
+ */
+
+#define SESSION_CLIENT_ID_SIZE 8
+
+typedef struct
+{
+    transport_t *link;
+    session_crypto_ctx_t psk_aead;
+    session_crypto_ctx_t aead;
+    uint8_t id[SESSION_CLIENT_ID_SIZE];
+    uint8_t iv_c2d[SESSION_CRYPTO_IV_SIZE];
+    uint8_t iv_d2c[SESSION_CRYPTO_IV_SIZE];
+    uint32_t seq;
+    framing_parser_t parser;
+    uint8_t rx_chunk[256];
+    size_t rx_len;
+    size_t rx_pos;
+} session_client_t;
+
+/**
+ * @brief Open the client end of a link and key the handshake with the PSK.
+ *
+ * @param client  Client to set up
+ * @param link    Client end of the link, opened here
+ * @param hsecret Pre-shared key as 64 hex digits, as in the HSECRET build flag
+ *
+ * @return true  If the client is ready to establish a session
+ * @return false Otherwise
+ */
+bool session_client_init(session_client_t *client, transport_t *link, const char *hsecret);
+
+/**
+ * @brief Run the two round trip handshake.
+ *
+ * @param client Initialised client
+ * @param suite  Only suite offered to the device
+ *
+ * @return true  If the device agreed on suite and echoed the timestamp
+ * @return false Otherwise
+ */
+bool session_client_establish(session_client_t *client, session_suite_t suite);
+
+/**
+ * @brief Send a request of the established session.
+ *
+ * @param client   Client with a session
+ * @param request  Request to send
+ * @param args     Arguments following the timestamp, may be NULL if args_len is 0
+ * @param args_len Length of args
+ *
+ * @return true  If the request was written to the link
+ * @return false Otherwise
+ */
+bool session_client_send(session_client_t *client, session_request_t request, const uint8_t *args, size_t args_len);
+
+/**
+ * @brief Wait for the next response and check it.
+ *
+ * @param client Client with a session
+ * @param length Plaintext length of the expected response
+ *
+ * @return true  If a response of that length authenticated and carries an OK status
+ * @return false Otherwise
+ */
+bool session_client_receive(session_client_t *client, size_t length);
+
+/**
+ * @brief Close the session, the resumption ticket of the response is dropped.
+ *
+ * @param client Client with a session
+ *
+ * @return true  If the device answered the close
+ * @return false Otherwise
+ */
+bool session_client_close(session_client_t *client);
+
+#endif
@@ -0,0 +1,13 @@
+#ifndef WS2812B_HOST_H
+#define WS2812B_HOST_H
+
+#include <stdint.h>
+
+/**
+ * @brief Get the frame last written by the ws2812b stand-in of the host.
+ *
+ * @return const uint8_t* R, G, B triplets of ws2812b_led_count() LEDs
+ */
+const uint8_t *ws2812b_host_frame(void);
+
+#endif
@@ -0,0 +1,157 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <sys/random.h>
+#include <sys/time.h>
+#include <time.h>
+#include "esp_random.h"
+#include "driver/gpio.h"
+#include "driver/temperature_sensor.h"
+
+/*
+ * Host stand-ins for the ESP-IDF services used by the firmware: the
+ * hardware RNG, the RTC, the GPIO matrix and the internal temperature
+ * sensor.
+ */
+
+#define TEMP_BASE_CELSIUS 24.0f
+#define TEMP_NOISE_STEPS 100
+#define TEMP_NOISE_STEP 0.01f
+
+struct temperature_sensor_obj_t
+{
+    bool enabled;
+};
+
+static struct temperature_sensor_obj_t temp_sensor;
+static int gpio_levels[GPIO_NUM_MAX];
+static int64_t rtc_offset_us;
+
+static int64_t host_time_us(void);
+
+uint32_t esp_random(void)
+{
+    uint32_t value = 0;
+    esp_fill_random(&value, sizeof(value));
+    return value;
+}
+
+void esp_fill_random(void *buf, size_t len)
+{
+    uint8_t *out = buf;
+
+    while (len > 0)
+    {
+        ssize_t n = getrandom(out, len, 0);
+        if (n > 0)
+        {
+            out += n;
+            len -= (size_t)n;
+        }
+    }
+}
+
+/*
+ * The firmware sets its RTC from the handshake timestamp. On the host the
+ * system clock is left alone and the difference is kept as an offset that
+ * gettimeofday() applies.
+ */
+int settimeofday(const struct timeval *tv, const struct timezone *tz)
+{
+    (void)tz;
+
+    if (tv != NULL)
+    {
+        int64_t requested_us = (int64_t)tv->tv_sec * 1000000LL + tv->tv_usec;
+        rtc_offset_us = requested_us - host_time_us();
+    }
+
+    return 0;
+}
+
+int gettimeofday(struct timeval *restrict tv, void *restrict tz)
+{
+    (void)tz;
+
+    int64_t now_us = host_time_us() + rtc_offset_us;
+    tv->tv_sec = now_us / 1000000LL;
+    tv->tv_usec = now_us % 1000000LL;
+
+    return 0;
+}
+
+esp_err_t gpio_config(const gpio_config_t *config)
+{
+    return (config != NULL) ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+esp_err_t gpio_set_level(gpio_num_t gpio_num, uint32_t level)
+{
+    esp_err_t status = ESP_ERR_INVALID_ARG;
+
+    if ((gpio_num >= 0) && (gpio_num < GPIO_NUM_MAX))
+    {
+        gpio_levels[gpio_num] = (level != 0);
+        status = ESP_OK;
+    }
+
+    return status;
+}
+
+int gpio_get_level(gpio_num_t gpio_num)
+{
+    int level = 0;
+
+    if ((gpio_num >= 0) && (gpio_num < GPIO_NUM_MAX))
+    {
+        level = gpio_levels[gpio_num];
+    }
+
+    return level;
+}
+
+esp_err_t temperature_sensor_install(const temperature_sensor_config_t *config, temperature_sensor_handle_t *ret_handle)
+{
+    esp_err_t status = ESP_ERR_INVALID_ARG;
+
+    if ((config != NULL) && (ret_handle != NULL))
+    {
+        temp_sensor.enabled = false;
+        *ret_handle = &temp_sensor;
+        status = ESP_OK;
+    }
+
+    return status;
+}
+
+esp_err_t temperature_sensor_enable(temperature_sensor_handle_t handle)
+{
+    esp_err_t status = ESP_ERR_INVALID_ARG;
+
+    if (handle != NULL)
+    {
+        handle->enabled = true;
+        status = ESP_OK;
+    }
+
+    return status;
+}
+
+esp_err_t temperature_sensor_get_celsius(temperature_sensor_handle_t handle, float *out_celsius)
+{
+    esp_err_t status = ESP_ERR_INVALID_STATE;
+
+    if ((handle != NULL) && handle->enabled && (out_celsius != NULL))
+    {
+        *out_celsius = TEMP_BASE_CELSIUS + (float)(esp_random() % TEMP_NOISE_STEPS) * TEMP_NOISE_STEP;
+        status = ESP_OK;
+    }
+
+    return status;
+}
+
+static int64_t host_time_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (int64_t)ts.tv_sec * 1000000LL + ts.tv_nsec / 1000;
+}
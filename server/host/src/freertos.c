@@ -0,0 +1,274 @@
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+
+/* Minimal FreeRTOS task, queue and mutex API on top of POSIX threads. */
+
+struct host_task
+{
+    pthread_t thread;
+    TaskFunction_t function;
+    void *param;
+};
+
+struct host_queue
+{
+    pthread_mutex_t lock;
+    pthread_cond_t changed;
+    UBaseType_t length;
+    UBaseType_t item_size;
+    UBaseType_t head;
+    UBaseType_t count;
+    uint8_t *items;
+};
+
+struct host_semaphore
+{
+    pthread_mutex_t lock;
+};
+
+static void *task_entry(void *arg);
+static void deadline_after(TickType_t ticks, struct timespec *deadline);
+static bool wait_changed(QueueHandle_t queue, TickType_t ticks, const struct timespec *deadline);
+
+BaseType_t xTaskCreate(TaskFunction_t task, const char *name, uint32_t stack_depth,
+                       void *param, UBaseType_t priority, TaskHandle_t *ret_handle)
+{
+    BaseType_t status = pdFAIL;
+    (void)name;
+    (void)stack_depth;
+    (void)priority;
+
+    struct host_task *handle = calloc(1, sizeof(struct host_task));
+
+    if (handle != NULL)
+    {
+        handle->function = task;
+        handle->param = param;
+
+        if (pthread_create(&handle->thread, NULL, task_entry, handle) == 0)
+        {
+            pthread_detach(handle->thread);
+            if (ret_handle != NULL)
+            {
+                *ret_handle = handle;
+            }
+            status = pdPASS;
+        }
+        else
+        {
+            free(handle);
+        }
+    }
+
+    return status;
+}
+
+void vTaskDelay(TickType_t ticks)
+{
+    TickType_t ms = pdTICKS_TO_MS(ticks);
+    struct timespec ts = {
+        .tv_sec = ms / 1000U,
+        .tv_nsec = (long)(ms % 1000U) * 1000000L};
+
+    while (nanosleep(&ts, &ts) != 0)
+    {
+    }
+}
+
+TickType_t xTaskGetTickCount(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (TickType_t)(ts.tv_sec * configTICK_RATE_HZ +
+                        ts.tv_nsec / (1000000000L / configTICK_RATE_HZ));
+}
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size)
+{
+    struct host_queue *queue = calloc(1, sizeof(struct host_queue));
+
+    if (queue != NULL)
+    {
+        queue->items = calloc(length, item_size);
+
+        if (queue->items != NULL)
+        {
+            pthread_condattr_t attr;
+            pthread_condattr_init(&attr);
+            pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+            pthread_cond_init(&queue->changed, &attr);
+            pthread_condattr_destroy(&attr);
+            pthread_mutex_init(&queue->lock, NULL);
+
+            queue->length = length;
+            queue->item_size = item_size;
+        }
+        else
+        {
+            free(queue);
+            queue = NULL;
+        }
+    }
+
+    return queue;
+}
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void *item, TickType_t ticks)
+{
+    BaseType_t status = pdFAIL;
+    struct timespec deadline;
+    deadline_after(ticks, &deadline);
+
+    pthread_mutex_lock(&queue->lock);
+
+    while ((queue->count == queue->length) && wait_changed(queue, ticks, &deadline))
+    {
+    }
+
+    if (queue->count < queue->length)
+    {
+        UBaseType_t tail = (queue->head + queue->count) % queue->length;
+        memcpy(queue->items + tail * queue->item_size, item, queue->item_size);
+        queue->count++;
+        pthread_cond_broadcast(&queue->changed);
+        status = pdPASS;
+    }
+
+    pthread_mutex_unlock(&queue->lock);
+
+    return status;
+}
+
+BaseType_t xQueueOverwrite(QueueHandle_t queue, const void *item)
+{
+    pthread_mutex_lock(&queue->lock);
+
+    memcpy(queue->items + queue->head * queue->item_size, item, queue->item_size);
+    queue->count = 1;
+    pthread_cond_broadcast(&queue->changed);
+
+    pthread_mutex_unlock(&queue->lock);
+
+    return pdPASS;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void *item, TickType_t ticks)
+{
+    BaseType_t status = pdFAIL;
+    struct timespec deadline;
+    deadline_after(ticks, &deadline);
+
+    pthread_mutex_lock(&queue->lock);
+
+    while ((queue->count == 0) && wait_changed(queue, ticks, &deadline))
+    {
+    }
+
+    if (queue->count > 0)
+    {
+        memcpy(item, queue->items + queue->head * queue->item_size, queue->item_size);
+        queue->head = (queue->head + 1) % queue->length;
+        queue->count--;
+        pthread_cond_broadcast(&queue->changed);
+        status = pdPASS;
+    }
+
+    pthread_mutex_unlock(&queue->lock);
+
+    return status;
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void)
+{
+    struct host_semaphore *mutex = calloc(1, sizeof(struct host_semaphore));
+
+    if (mutex != NULL)
+    {
+        pthread_mutex_init(&mutex->lock, NULL);
+    }
+
+    return mutex;
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t mutex, TickType_t ticks)
+{
+    (void)ticks;
+    return (pthread_mutex_lock(&mutex->lock) == 0) ? pdPASS : pdFAIL;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t mutex)
+{
+    return (pthread_mutex_unlock(&mutex->lock) == 0) ? pdPASS : pdFAIL;
+}
+
+SemaphoreHandle_t xSemaphoreCreateRecursiveMutex(void)
+{
+    struct host_semaphore *mutex = calloc(1, sizeof(struct host_semaphore));
+
+    if (mutex != NULL)
+    {
+        pthread_mutexattr_t attr;
+        pthread_mutexattr_init(&attr);
+        pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+        pthread_mutex_init(&mutex->lock, &attr);
+        pthread_mutexattr_destroy(&attr);
+    }
+
+    return mutex;
+}
+
+BaseType_t xSemaphoreTakeRecursive(SemaphoreHandle_t mutex, TickType_t ticks)
+{
+    (void)ticks;
+    return (pthread_mutex_lock(&mutex->lock) == 0) ? pdPASS : pdFAIL;
+}
+
+BaseType_t xSemaphoreGiveRecursive(SemaphoreHandle_t mutex)
+{
+    return (pthread_mutex_unlock(&mutex->lock) == 0) ? pdPASS : pdFAIL;
+}
+
+static void deadline_after(TickType_t ticks, struct timespec *deadline)
+{
+    TickType_t ms = pdTICKS_TO_MS(ticks);
+    clock_gettime(CLOCK_MONOTONIC, deadline);
+
+    deadline->tv_sec += ms / 1000U;
+    deadline->tv_nsec += (long)(ms % 1000U) * 1000000L;
+    if (deadline->tv_nsec >= 1000000000L)
+    {
+        deadline->tv_sec++;
+        deadline->tv_nsec -= 1000000000L;
+    }
+}
+
+/* Wait for the queue to change; false once the deadline has passed. */
+static bool wait_changed(QueueHandle_t queue, TickType_t ticks, const struct timespec *deadline)
+{
+    bool waiting = false;
+
+    if (ticks == portMAX_DELAY)
+    {
+        waiting = (pthread_cond_wait(&queue->changed, &queue->lock) == 0);
+    }
+    else if (ticks > 0)
+    {
+        waiting = (pthread_cond_timedwait(&queue->changed, &queue->lock, deadline) == 0);
+    }
+
+    return waiting;
+}
+
+static void *task_entry(void *arg)
+{
+    struct host_task *handle = arg;
+    handle->function(handle->param);
+    return NULL;
+}
@@ -0,0 +1,270 @@
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <psa/crypto.h>
+#include "session_client.h"
+
+#define RECEIVE_WAIT_MS 1000
+
+#define KEY_SIZE SESSION_CRYPTO_KEY_SIZE
+#define IV_SIZE SESSION_CRYPTO_IV_SIZE
+#define TAG_SIZE SESSION_CRYPTO_TAG_SIZE
+#define SESSION_ID_SIZE SESSION_CLIENT_ID_SIZE
+#define RAND_SIZE 8
+#define TIME_STAMP_SIZE 8
+#define SEQ_SIZE 4
+#define COUNTER_SIZE 4
+#define HMAC_SIZE 32
+#define REQUEST_SIZE 1
+
+static bool client_write(session_client_t *client, uint8_t type, const uint8_t *payload, size_t length);
+static const frame_t *client_read(session_client_t *client, uint8_t type);
+static bool hmac_sha256(const uint8_t *key, const uint8_t *msg, size_t msg_len, uint8_t *mac);
+static void data_iv(const uint8_t *base, uint32_t counter, uint8_t *iv);
+static void write_be32(uint8_t *buf, uint32_t v);
+static void write_be64(uint8_t *buf, uint64_t v);
+static uint32_t read_be32(const uint8_t *buf);
+static uint64_t now_us(void);
+
+bool session_client_init(session_client_t *client, transport_t *link, const char *hsecret)
+{
+    bool status = (strlen(hsecret) == 2 * KEY_SIZE);
+    uint8_t psk[KEY_SIZE];
+
+    for (size_t i = 0; status && (i < KEY_SIZE); i++)
+    {
+        unsigned int byte = 0;
+        status = (1 == sscanf(hsecret + 2 * i, "%2x", &byte));
+        psk[i] = (uint8_t)byte;
+    }
+
+    client->link = link;
+    client->seq = 0;
+    client->rx_len = 0;
+    client->rx_pos = 0;
+    framing_parser_reset(&client->parser);
+    session_crypto_init(&client->psk_aead);
+    session_crypto_init(&client->aead);
+
+    status = status && transport_open(link, "") &&
+             session_crypto_set_key(&client->psk_aead, SESSION_SUITE_AES_256_GCM, psk);
+
+    memset(psk, 0, sizeof(psk));
+
+    return status;
+}
+
+/* The handshake of client/session.py, offering a single suite. */
+bool session_client_establish(session_client_t *client, session_suite_t suite)
+{
+    bool status = false;
+    uint8_t key[KEY_SIZE];
+    uint8_t plaintext[KEY_SIZE + RAND_SIZE + 2];
+    uint8_t message[IV_SIZE + sizeof(plaintext) + TAG_SIZE];
+    uint8_t aad[RAND_SIZE + 1];
+    uint8_t zero_id[SESSION_ID_SIZE] = {0};
+    uint8_t timestamp[TIME_STAMP_SIZE];
+    uint8_t echoed[TIME_STAMP_SIZE];
+    uint8_t mac[HMAC_SIZE];
+    const frame_t *frame;
+
+    (void)psa_generate_random(plaintext, KEY_SIZE + RAND_SIZE);
+    (void)psa_generate_random(message, IV_SIZE);
+    memcpy(key, plaintext, KEY_SIZE);
+    memcpy(aad, plaintext + KEY_SIZE, RAND_SIZE);
+    aad[RAND_SIZE] = suite;
+    plaintext[KEY_SIZE + RAND_SIZE] = 1;
+    plaintext[KEY_SIZE + RAND_SIZE + 1] = suite;
+
+    if (session_crypto_encrypt(&client->psk_aead, message, zero_id, sizeof(zero_id), plaintext, sizeof(plaintext),
+                               message + IV_SIZE) &&
+        client_write(client, FRAME_HANDSHAKE, message, sizeof(message)) &&
+        ((frame = client_read(client, FRAME_HANDSHAKE)) != NULL) &&
+        (frame->length == 1 + IV_SIZE + SESSION_ID_SIZE + TAG_SIZE) && (frame->payload[0] == suite) &&
+        session_crypto_set_key(&client->aead, suite, key) &&
+        session_crypto_decrypt(&client->aead, frame->payload + 1, aad, sizeof(aad), frame->payload + 1 + IV_SIZE,
+                               SESSION_ID_SIZE + TAG_SIZE, client->id))
+    {
+        write_be64(timestamp, now_us());
+        (void)psa_generate_random(message, IV_SIZE);
+
+        if (session_crypto_encrypt(&client->aead, message, client->id, SESSION_ID_SIZE, timestamp, TIME_STAMP_SIZE,
+                                   message + IV_SIZE) &&
+            client_write(client, FRAME_HANDSHAKE, message, IV_SIZE + TIME_STAMP_SIZE + TAG_SIZE) &&
+            ((frame = client_read(client, FRAME_HANDSHAKE)) != NULL) &&
+            (frame->length == IV_SIZE + TIME_STAMP_SIZE + TAG_SIZE) &&
+            session_crypto_decrypt(&client->aead, frame->payload, client->id, SESSION_ID_SIZE,
+                                   frame->payload + IV_SIZE, TIME_STAMP_SIZE + TAG_SIZE, echoed) &&
+            (0 == memcmp(timestamp, echoed, TIME_STAMP_SIZE)) &&
+            hmac_sha256(key, (const uint8_t *)"c2d iv", 6, mac))
+        {
+            memcpy(client->iv_c2d, mac, IV_SIZE);
+            status = hmac_sha256(key, (const uint8_t *)"d2c iv", 6, mac);
+            memcpy(client->iv_d2c, mac, IV_SIZE);
+            client->seq = 0;
+        }
+    }
+
+    memset(key, 0, sizeof(key));
+
+    return status;
+}
+
+bool session_client_send(session_client_t *client, session_request_t request, const uint8_t *args, size_t args_len)
+{
+    bool status = false;
+    uint8_t plaintext[FRAMING_MAX_PAYLOAD];
+    uint8_t message[FRAMING_MAX_PAYLOAD];
+    uint8_t aad[SESSION_ID_SIZE + SEQ_SIZE];
+    uint8_t iv[IV_SIZE];
+    size_t length = REQUEST_SIZE + TIME_STAMP_SIZE + args_len;
+
+    if (SEQ_SIZE + length + TAG_SIZE <= sizeof(message))
+    {
+        plaintext[0] = (uint8_t)request;
+        write_be64(plaintext + REQUEST_SIZE, now_us());
+        if (args_len > 0)
+        {
+            memcpy(plaintext + REQUEST_SIZE + TIME_STAMP_SIZE, args, args_len);
+        }
+        write_be32(message, client->seq);
+        memcpy(aad, client->id, SESSION_ID_SIZE);
+        write_be32(aad + SESSION_ID_SIZE, client->seq);
+        data_iv(client->iv_c2d, client->seq, iv);
+        // Spent even if the write fails, the nonce must never be used twice
+        client->seq++;
+
+        status = session_crypto_encrypt(&client->aead, iv, aad, sizeof(aad), plaintext, length, message + SEQ_SIZE) &&
+                 client_write(client, FRAME_DATA, message, SEQ_SIZE + length + TAG_SIZE);
+    }
+
+    return status;
+}
+
+bool session_client_receive(session_client_t *client, size_t length)
+{
+    bool status = false;
+    uint8_t plaintext[FRAMING_MAX_PAYLOAD];
+    uint8_t aad[SESSION_ID_SIZE + SEQ_SIZE];
+    uint8_t iv[IV_SIZE];
+    const frame_t *frame = client_read(client, FRAME_DATA);
+
+    if ((frame != NULL) && (frame->length == COUNTER_SIZE + SEQ_SIZE + length + TAG_SIZE))
+    {
+        data_iv(client->iv_d2c, read_be32(frame->payload), iv);
+        memcpy(aad, client->id, SESSION_ID_SIZE);
+        memcpy(aad + SESSION_ID_SIZE, frame->payload + COUNTER_SIZE, SEQ_SIZE);
+
+        status = session_crypto_decrypt(&client->aead, iv, aad, sizeof(aad), frame->payload + COUNTER_SIZE + SEQ_SIZE,
+                                        length + TAG_SIZE, plaintext) &&
+                 (plaintext[0] == 1);
+    }
+
+    return status;
+}
+
+/* The close response carries a resumption ticket, its length is not checked. */
+bool session_client_close(session_client_t *client)
+{
+    bool status = session_client_send(client, CLOSE_SESSION, NULL, 0) &&
+                  (client_read(client, FRAME_DATA) != NULL);
+
+    session_crypto_clear(&client->aead);
+
+    return status;
+}
+
+static bool client_write(session_client_t *client, uint8_t type, const uint8_t *payload, size_t length)
+{
+    uint8_t frame[FRAMING_MAX_PAYLOAD + FRAMING_OVERHEAD];
+    size_t size = framing_encode(type, payload, length, frame);
+
+    return (size > 0) && transport_write(client->link, frame, size);
+}
+
+static const frame_t *client_read(session_client_t *client, uint8_t type)
+{
+    const frame_t *frame = NULL;
+    bool idle = false;
+
+    while ((frame == NULL) && !idle)
+    {
+        frame = framing_parser_next(&client->parser) ? &client->parser.frame : NULL;
+
+        while ((frame == NULL) && (client->rx_pos < client->rx_len))
+        {
+            frame = framing_parser_feed(&client->parser, client->rx_chunk[client->rx_pos++]) ? &client->parser.frame
+                                                                                             : NULL;
+        }
+
+        if (frame == NULL)
+        {
+            int len = transport_read(client->link, client->rx_chunk, sizeof(client->rx_chunk), RECEIVE_WAIT_MS);
+            client->rx_pos = 0;
+            client->rx_len = (len > 0) ? (size_t)len : 0;
+            idle = (len <= 0);
+        }
+    }
+
+    return ((frame != NULL) && (frame->type == type)) ? frame : NULL;
+}
+
+static bool hmac_sha256(const uint8_t *key, const uint8_t *msg, size_t msg_len, uint8_t *mac)
+{
+    bool status = false;
+    psa_key_id_t mac_key = 0;
+    size_t out_len;
+    psa_key_attributes_t attr = PSA_KEY_ATTRIBUTES_INIT;
+
+    psa_set_key_type(&attr, PSA_KEY_TYPE_HMAC);
+    psa_set_key_bits(&attr, KEY_SIZE * 8);
+    psa_set_key_usage_flags(&attr, PSA_KEY_USAGE_SIGN_MESSAGE);
+    psa_set_key_algorithm(&attr, PSA_ALG_HMAC(PSA_ALG_SHA_256));
+
+    if (PSA_SUCCESS == psa_import_key(&attr, key, KEY_SIZE, &mac_key))
+    {
+        status = (PSA_SUCCESS == psa_mac_compute(mac_key, PSA_ALG_HMAC(PSA_ALG_SHA_256), msg, msg_len, mac,
+                                                 HMAC_SIZE, &out_len));
+        psa_destroy_key(mac_key);
+    }
+
+    return status;
+}
+
+static void data_iv(const uint8_t *base, uint32_t counter, uint8_t *iv)
+{
+    memcpy(iv, base, IV_SIZE);
+    iv[IV_SIZE - 4] ^= (counter >> 24) & 0xFF;
+    iv[IV_SIZE - 3] ^= (counter >> 16) & 0xFF;
+    iv[IV_SIZE - 2] ^= (counter >> 8) & 0xFF;
+    iv[IV_SIZE - 1] ^= counter & 0xFF;
+}
+
+static void write_be32(uint8_t *buf, uint32_t v)
+{
+    for (int i = 0; i < 4; i++)
+    {
+        buf[i] = (uint8_t)(v >> (24 - 8 * i));
+    }
+}
+
+static void write_be64(uint8_t *buf, uint64_t v)
+{
+    for (int i = 0; i < 8; i++)
+    {
+        buf[i] = (uint8_t)(v >> (56 - 8 * i));
+    }
+}
+
+static uint32_t read_be32(const uint8_t *buf)
+{
+    return ((uint32_t)buf[0] << 24) | ((uint32_t)buf[1] << 16) | ((uint32_t)buf[2] << 8) | buf[3];
+}
+
+static uint64_t now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+
+    return (uint64_t)ts.tv_sec * 1000000ULL + (uint64_t)ts.tv_nsec / 1000ULL;
+}
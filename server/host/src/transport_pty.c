@@ -0,0 +1,125 @@
+#define _GNU_SOURCE
+#include <fcntl.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/ioctl.h>
+#include <termios.h>
+#include <unistd.h>
+#include "transport.h"
+
+/*
+ * POSIX backend of the transport. The device side of the link is the
+ * master end of a pseudo-terminal, the client opens the slave path
+ * printed by transport_open() as if it were the serial port.
+ */
+
+#define WAIT_FOREVER -1
+
+static int master_fd = -1;
+static int slave_fd = -1;
+
+static bool pty_open(transport_t *transport, const char *params);
+static int pty_read(transport_t *transport, uint8_t *buf, size_t length, size_t wait_ms);
+static bool pty_write(transport_t *transport, const uint8_t *data, size_t length);
+static size_t pty_poll(transport_t *transport, size_t wait_ms);
+static bool wait_readable(size_t wait_ms);
+
+static const transport_ops_t pty_ops = {
+    .open = pty_open,
+    .read = pty_read,
+    .write = pty_write,
+    .poll = pty_poll,
+};
+
+transport_t transport_pty = {.ops = &pty_ops, .ctx = NULL};
+
+static bool pty_open(transport_t *transport, const char *params)
+{
+    (void)transport;
+    (void)params;
+
+    bool status = false;
+
+    master_fd = posix_openpt(O_RDWR | O_NOCTTY);
+
+    if ((master_fd >= 0) && (grantpt(master_fd) == 0) && (unlockpt(master_fd) == 0))
+    {
+        // Keep the slave open ourselves so the master never sees a hang-up
+        // while no client is attached.
+        slave_fd = open(ptsname(master_fd), O_RDWR | O_NOCTTY);
+
+        struct termios tio;
+        if ((slave_fd >= 0) && (tcgetattr(slave_fd, &tio) == 0))
+        {
+            cfmakeraw(&tio);
+            if (tcsetattr(slave_fd, TCSANOW, &tio) == 0)
+            {
+                printf("PTY: %s\n", ptsname(master_fd));
+                fflush(stdout);
+                status = true;
+            }
+        }
+    }
+
+    return status;
+}
+
+static int pty_read(transport_t *transport, uint8_t *buf, size_t length, size_t wait_ms)
+{
+    (void)transport;
+
+    int len = 0;
+
+    // A forever wait keeps going across spurious wake-ups
+    do
+    {
+        if (wait_readable(wait_ms))
+        {
+            ssize_t n = read(master_fd, buf, length);
+            len = (n > 0) ? (int)n : 0;
+        }
+    } while ((len == 0) && (wait_ms == TRANSPORT_WAIT_FOREVER));
+
+    return len;
+}
+
+static bool pty_write(transport_t *transport, const uint8_t *data, size_t length)
+{
+    (void)transport;
+
+    size_t written = 0;
+
+    while (written < length)
+    {
+        ssize_t n = write(master_fd, data + written, length - written);
+        if (n <= 0)
+        {
+            break;
+        }
+        written += (size_t)n;
+    }
+
+    return (written == length);
+}
+
+static size_t pty_poll(transport_t *transport, size_t wait_ms)
+{
+    (void)transport;
+
+    int available = 0;
+
+    if (!wait_readable(wait_ms) || (ioctl(master_fd, FIONREAD, &available) != 0))
+    {
+        available = 0;
+    }
+
+    return (size_t)available;
+}
+
+static bool wait_readable(size_t wait_ms)
+{
+    struct pollfd pfd = {.fd = master_fd, .events = POLLIN};
+
+    return (poll(&pfd, 1, (wait_ms == TRANSPORT_WAIT_FOREVER) ? WAIT_FOREVER : (int)wait_ms) > 0);
+}
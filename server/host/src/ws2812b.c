@@ -0,0 +1,101 @@
+#include <string.h>
+#include "ws2812b.h"
+#include "ws2812b_host.h"
+
+/* The host has no LED strip, the last frame is only kept for inspection.
+ * Effects render their first frame so that the renderer is exercised. */
+
+static uint8_t frame[WS2812B_MAX_LEDS * 3];
+static uint32_t led_count;
+
+bool ws2812b_init(int gpio, uint32_t count)
+{
+    (void)gpio;
+    led_count = count;
+
+    return (0 < count) && (count <= WS2812B_MAX_LEDS);
+}
+
+uint32_t ws2812b_led_count(void)
+{
+    return led_count;
+}
+
+void ws2812b_set_color(uint8_t _red, uint8_t _green, uint8_t _blue)
+{
+    for (uint32_t i = 0; i < led_count * 3; i += 3)
+    {
+        frame[i] = _red;
+        frame[i + 1] = _green;
+        frame[i + 2] = _blue;
+    }
+}
+
+bool ws2812b_set_pixels(uint32_t start, uint32_t count, const uint8_t *rgb)
+{
+    bool status = false;
+
+    if ((start <= led_count) && (count <= led_count - start) && ((NULL != rgb) || (0 == count)))
+    {
+        memcpy(&frame[start * 3], rgb, count * 3);
+        status = true;
+    }
+
+    return status;
+}
+
+void ws2812b_set_frame(const uint8_t *rgb)
+{
+    (void)ws2812b_set_pixels(0, led_count, rgb);
+}
+
+void ws2812b_set_effect(const ws2812b_effect_t *_effect)
+{
+    ws2812b_effect_render(_effect, 0, frame, led_count);
+}
+
+void ws2812b_set_refresh_period(uint32_t period_ms)
+{
+    (void)period_ms;
+}
+
+bool ws2812b_fill(uint32_t start, uint32_t count, const uint8_t *rgb)
+{
+    bool status = false;
+
+    if ((start <= led_count) && (count <= led_count - start) && (NULL != rgb))
+    {
+        for (uint32_t i = start * 3; i < (start + count) * 3; i += 3)
+        {
+            frame[i] = rgb[0];
+            frame[i + 1] = rgb[1];
+            frame[i + 2] = rgb[2];
+        }
+        status = true;
+    }
+
+    return status;
+}
+
+void ws2812b_begin_update(void)
+{
+}
+
+void ws2812b_end_update(void)
+{
+}
+
+bool ws2812b_set_gamma(float gamma)
+{
+    return gamma > 0.0f;
+}
+
+void ws2812b_set_brightness(uint8_t brightness)
+{
+    (void)brightness;
+}
+
+const uint8_t *ws2812b_host_frame(void)
+{
+    return frame;
+}
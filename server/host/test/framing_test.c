@@ -0,0 +1,120 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "framing.h"
+
+/* Feeds damaged byte streams into the stream parser and checks that every
+ * intact frame behind the damage is still returned, in order. */
+
+#define MAX_FRAMES 4
+
+typedef struct
+{
+    const char *name;
+    uint8_t stream[3 * (FRAMING_MAX_PAYLOAD + FRAMING_OVERHEAD)];
+    size_t len;
+    uint8_t expected; // number of intact frames, their type is their position from 1
+} stream_case_t;
+
+static framing_parser_t parser;
+static stream_case_t stream;
+
+static void start(const char *name);
+static void append(const uint8_t *bytes, size_t len);
+static void append_frame(uint8_t type, size_t length);
+static bool run(void);
+
+static void start(const char *name)
+{
+    stream.name = name;
+    stream.len = 0;
+    stream.expected = 0;
+}
+
+static void append(const uint8_t *bytes, size_t len)
+{
+    memcpy(stream.stream + stream.len, bytes, len);
+    stream.len += len;
+}
+
+/* The payload of frame n repeats n, so its origin can be told apart. */
+static void append_frame(uint8_t type, size_t length)
+{
+    uint8_t payload[FRAMING_MAX_PAYLOAD];
+
+    memset(payload, type, length);
+    stream.len += framing_encode(type, payload, length, stream.stream + stream.len);
+}
+
+static bool run(void)
+{
+    bool status = true;
+    uint8_t received = 0;
+
+    framing_parser_reset(&parser);
+
+    for (size_t i = 0; status && (i <= stream.len); i++)
+    {
+        bool complete = (i < stream.len) ? framing_parser_feed(&parser, stream.stream[i]) : framing_parser_next(&parser);
+
+        while (status && complete)
+        {
+            received++;
+            status = (parser.frame.type == received) && (received <= stream.expected);
+            for (size_t j = 0; status && (j < parser.frame.length); j++)
+            {
+                status = (parser.frame.payload[j] == received);
+            }
+            complete = framing_parser_next(&parser);
+        }
+    }
+
+    status = status && (received == stream.expected);
+    printf("%-32s %s\n", stream.name, status ? "passed" : "failed");
+
+    return status;
+}
+
+int main(void)
+{
+    bool status = true;
+    const uint8_t false_header[] = {FRAMING_SYNC_0, FRAMING_SYNC_1, 0x00, 0xC8, 0x01};
+    const uint8_t oversized_header[] = {FRAMING_SYNC_0, FRAMING_SYNC_1, 0xFF, 0xFF, 0x01};
+    const uint8_t noise[] = {0x00, FRAMING_SYNC_0, 0x13, FRAMING_SYNC_0, FRAMING_SYNC_0};
+
+    // A false sync word claiming 200 bytes would swallow the frames behind it
+    start("corrupted header");
+    append(false_header, sizeof(false_header));
+    append_frame(1, 40);
+    append_frame(2, 0);
+    append_frame(3, 300);
+    stream.expected = 3;
+    status = run() && status;
+
+    start("oversized length");
+    append(oversized_header, sizeof(oversized_header));
+    append_frame(1, 16);
+    stream.expected = 1;
+    status = run() && status;
+
+    // Damage to the CRC of the first frame loses that frame only
+    start("bad crc");
+    append_frame(1, 20);
+    stream.stream[stream.len - 1] ^= 0xFF;
+    append_frame(1, 20);
+    append_frame(2, 8);
+    stream.expected = 2;
+    status = run() && status;
+
+    start("noise between frames");
+    append(noise, sizeof(noise));
+    append_frame(1, FRAMING_MAX_PAYLOAD);
+    append(noise, sizeof(noise));
+    append_frame(2, 1);
+    stream.expected = 2;
+    status = run() && status;
+
+    printf("%s\n", status ? "framing: passed" : "framing: failed");
+
+    return status ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,145 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "session.h"
+#include "session_client.h"
+#include "transport_loopback.h"
+#include "ws2812b.h"
+#include "ws2812b_host.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+/* Runs the firmware request loop of src/main.c in a task behind the
+ * loopback transport, uploads a multi-pixel SET_PIXELS frame and checks
+ * the frame the strip ends up with. Two bad frames follow, one running
+ * off the strip and one with a palette index out of range, both must be
+ * refused without changing a single pixel. */
+
+#define STATUS_RESPONSE_SIZE (1 + 8)
+#define START_PIXEL 2
+#define BYTES_PER_PIXEL 3
+
+extern void app_main(void);
+
+/* main.c opens SESSION_TRANSPORT, which is the device end of the loopback here. */
+transport_t transport_pty;
+
+static transport_loopback_t loopback;
+
+/* Three runs, from START_PIXEL, of the palette red, white and blue. */
+static const uint8_t palette[] = {255, 0, 0, 255, 255, 255, 0, 0, 255};
+static const uint8_t runs[] = {3, 0, 5, 1, 2, 2};
+
+/* The first run of each still fits, so drawing it before refusing would show. */
+static const uint8_t overrun[] = {3, 0, 2, 1};
+static const uint8_t bad_index[] = {2, 0, 1, 3};
+
+static void app_task(void *param);
+static bool upload(session_client_t *client, uint16_t start, const uint8_t *frame_runs, size_t runs_len);
+static bool frame_matches(void);
+
+static void app_task(void *param)
+{
+    (void)param;
+
+    app_main();
+}
+
+/* Returns true only if the device answered with an OK status. */
+static bool upload(session_client_t *client, uint16_t start, const uint8_t *frame_runs, size_t runs_len)
+{
+    uint8_t args[3 + sizeof(palette) + sizeof(runs)];
+
+    args[0] = (start >> 8) & 0xFF;
+    args[1] = start & 0xFF;
+    args[2] = sizeof(palette) / BYTES_PER_PIXEL;
+    memcpy(args + 3, palette, sizeof(palette));
+    memcpy(args + 3 + sizeof(palette), frame_runs, runs_len);
+
+    return session_client_send(client, SET_PIXELS, args, 3 + sizeof(palette) + runs_len) &&
+           session_client_receive(client, STATUS_RESPONSE_SIZE);
+}
+
+/* Pixels outside the runs keep the green of the status. */
+static bool frame_matches(void)
+{
+    bool status = true;
+    const uint8_t green[BYTES_PER_PIXEL] = {0, 255, 0};
+    const uint8_t *frame = ws2812b_host_frame();
+    uint32_t pixel = 0;
+
+    for (; status && (pixel < START_PIXEL); pixel++)
+    {
+        status = (0 == memcmp(frame + pixel * BYTES_PER_PIXEL, green, BYTES_PER_PIXEL));
+    }
+
+    for (size_t run = 0; status && (run < sizeof(runs)); run += 2)
+    {
+        for (uint32_t end = pixel + runs[run]; status && (pixel < end); pixel++)
+        {
+            status = (0 == memcmp(frame + pixel * BYTES_PER_PIXEL, palette + runs[run + 1] * BYTES_PER_PIXEL,
+                                  BYTES_PER_PIXEL));
+        }
+    }
+
+    for (; status && (pixel < ws2812b_led_count()); pixel++)
+    {
+        status = (0 == memcmp(frame + pixel * BYTES_PER_PIXEL, green, BYTES_PER_PIXEL));
+    }
+
+    if (!status)
+    {
+        printf("pixel %u does not match\n", (unsigned int)(pixel - 1));
+    }
+
+    return status;
+}
+
+int main(void)
+{
+    session_client_t client;
+
+    bool status = transport_loopback_init(&loopback);
+
+    transport_pty = loopback.device.transport;
+    status = status && (pdPASS == xTaskCreate(app_task, "app", 8192, NULL, 0, NULL)) &&
+             session_client_init(&client, &loopback.client.transport, HSECRET) &&
+             session_client_establish(&client, SESSION_SUITE_AES_256_GCM);
+
+    if (!status)
+    {
+        printf("no session with the device\n");
+    }
+    else if (!upload(&client, START_PIXEL, runs, sizeof(runs)))
+    {
+        printf("SET_PIXELS was refused\n");
+        status = false;
+    }
+    else if (ws2812b_led_count() != RGB_LED_COUNT)
+    {
+        printf("strip has %u LEDs instead of %u\n", (unsigned int)ws2812b_led_count(), (unsigned int)RGB_LED_COUNT);
+        status = false;
+    }
+    else if (!frame_matches())
+    {
+        status = false;
+    }
+    else if (upload(&client, RGB_LED_COUNT - 4, overrun, sizeof(overrun)) || !frame_matches())
+    {
+        printf("a frame running off the strip was drawn\n");
+        status = false;
+    }
+    else if (upload(&client, 0, bad_index, sizeof(bad_index)) || !frame_matches())
+    {
+        printf("a frame with a bad palette index was drawn\n");
+        status = false;
+    }
+    else
+    {
+        status = session_client_close(&client);
+    }
+
+    printf("%s\n", status ? "set_pixels: passed" : "set_pixels: failed");
+
+    return status ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,232 @@
+#include <string.h>
+#include "framing.h"
+#include "transport.h"
+
+#define CRC_INIT 0xFFFF
+#define CRC_POLY 0x1021
+
+#define RX_CHUNK_SIZE 256
+
+static transport_t *client_link = NULL;
+static framing_parser_t rx_parser;
+static uint8_t rx_chunk[RX_CHUNK_SIZE];
+static size_t rx_chunk_len = 0;
+static size_t rx_chunk_pos = 0;
+static uint8_t tx_frame[FRAMING_MAX_PAYLOAD + FRAMING_OVERHEAD];
+
+static uint16_t crc16_update(uint16_t crc, uint8_t byte);
+static void drop(framing_parser_t *parser, size_t count);
+static size_t find_sync(const framing_parser_t *parser);
+static size_t seal(uint8_t type, size_t length, uint8_t *out);
+
+bool framing_init(transport_t *transport, const char *params)
+{
+    client_link = transport;
+    framing_parser_reset(&rx_parser);
+    rx_chunk_len = 0;
+    rx_chunk_pos = 0;
+
+    return transport_open(client_link, params);
+}
+
+void framing_parser_reset(framing_parser_t *parser)
+{
+    parser->len = 0;
+    parser->consumed = 0;
+    parser->frame.length = 0;
+    parser->frame.payload = parser->buf + FRAMING_HEADER_SIZE;
+}
+
+bool framing_parser_feed(framing_parser_t *parser, uint8_t byte)
+{
+    drop(parser, parser->consumed);
+    parser->consumed = 0;
+    // The candidate is resolved once it is complete, so it never outgrows the buffer
+    parser->buf[parser->len++] = byte;
+
+    return framing_parser_next(parser);
+}
+
+bool framing_parser_next(framing_parser_t *parser)
+{
+    bool complete = false;
+    bool waiting = false;
+
+    drop(parser, parser->consumed);
+    parser->consumed = 0;
+
+    while (!complete && !waiting)
+    {
+        drop(parser, find_sync(parser));
+
+        uint16_t length = (parser->len >= FRAMING_HEADER_SIZE) ? ((uint16_t)parser->buf[2] << 8) | parser->buf[3] : 0;
+        size_t size = FRAMING_OVERHEAD + length;
+
+        if ((parser->len < FRAMING_HEADER_SIZE) || ((length <= FRAMING_MAX_PAYLOAD) && (parser->len < size)))
+        {
+            waiting = true;
+        }
+        else if (length > FRAMING_MAX_PAYLOAD)
+        {
+            // Cannot be a real header, search again from the next byte
+            drop(parser, 1);
+        }
+        else
+        {
+            uint16_t crc = CRC_INIT;
+            for (size_t i = sizeof(uint16_t); i < size; i++)
+            {
+                crc = crc16_update(crc, parser->buf[i]);
+            }
+
+            // Running the CRC over the received CRC as well leaves 0 for an intact frame
+            if (crc == 0)
+            {
+                parser->frame.type = parser->buf[4];
+                parser->frame.length = length;
+                parser->consumed = (uint16_t)size;
+                complete = true;
+            }
+            else
+            {
+                drop(parser, 1);
+            }
+        }
+    }
+
+    return complete;
+}
+
+size_t framing_encode(uint8_t type, const uint8_t *payload, size_t length, uint8_t *out)
+{
+    size_t size = 0;
+
+    if (length <= FRAMING_MAX_PAYLOAD)
+    {
+        memcpy(out + FRAMING_HEADER_SIZE, payload, length);
+        size = seal(type, length, out);
+    }
+
+    return size;
+}
+
+uint8_t *framing_tx_payload(void)
+{
+    return tx_frame + FRAMING_HEADER_SIZE;
+}
+
+bool framing_send(uint8_t type, size_t length)
+{
+    bool status = false;
+
+    if (length <= FRAMING_MAX_PAYLOAD)
+    {
+        status = transport_write(client_link, tx_frame, seal(type, length, tx_frame));
+    }
+
+    return status;
+}
+
+bool framing_write(uint8_t type, const uint8_t *payload, size_t length)
+{
+    bool status = false;
+
+    if (length <= FRAMING_MAX_PAYLOAD)
+    {
+        memcpy(framing_tx_payload(), payload, length);
+        status = framing_send(type, length);
+    }
+
+    return status;
+}
+
+bool framing_read(frame_t **frame, size_t wait_ms)
+{
+    bool status = false;
+    bool idle = false;
+
+    while (!status && !idle)
+    {
+        status = framing_parser_next(&rx_parser);
+
+        while (!status && (rx_chunk_pos < rx_chunk_len))
+        {
+            status = framing_parser_feed(&rx_parser, rx_chunk[rx_chunk_pos++]);
+        }
+
+        if (!status)
+        {
+            int len = transport_read(client_link, rx_chunk, sizeof(rx_chunk), wait_ms);
+
+            rx_chunk_pos = 0;
+            rx_chunk_len = (len > 0) ? (size_t)len : 0;
+            idle = (len <= 0);
+        }
+    }
+
+    if (status)
+    {
+        *frame = &rx_parser.frame;
+    }
+
+    return status;
+}
+
+/* Drops the first count bytes of the candidate. */
+static void drop(framing_parser_t *parser, size_t count)
+{
+    if (count > 0)
+    {
+        parser->len -= count;
+        memmove(parser->buf, parser->buf + count, parser->len);
+    }
+}
+
+/* Offset of the first byte that can start a sync word, the length of the candidate if none. */
+static size_t find_sync(const framing_parser_t *parser)
+{
+    size_t offset = 0;
+
+    while ((offset < parser->len) &&
+           ((parser->buf[offset] != FRAMING_SYNC_0) ||
+            ((offset + 1 < parser->len) && (parser->buf[offset + 1] != FRAMING_SYNC_1))))
+    {
+        offset++;
+    }
+
+    return offset;
+}
+
+static uint16_t crc16_update(uint16_t crc, uint8_t byte)
+{
+    crc ^= (uint16_t)byte << 8;
+
+    for (int i = 0; i < 8; i++)
+    {
+        crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ CRC_POLY) : (uint16_t)(crc << 1);
+    }
+
+    return crc;
+}
+
+/* Writes the header and the CRC around the length bytes of payload already in place in out. */
+static size_t seal(uint8_t type, size_t length, uint8_t *out)
+{
+    uint16_t crc = CRC_INIT;
+
+    out[0] = FRAMING_SYNC_0;
+    out[1] = FRAMING_SYNC_1;
+    out[2] = (length >> 8) & 0xFF;
+    out[3] = length & 0xFF;
+    out[4] = type;
+
+    for (size_t i = 2; i < FRAMING_HEADER_SIZE + length; i++)
+    {
+        crc = crc16_update(crc, out[i]);
+    }
+
+    out[FRAMING_HEADER_SIZE + length] = (crc >> 8) & 0xFF;
+    out[FRAMING_HEADER_SIZE + length + 1] = crc & 0xFF;
+
+    return length + FRAMING_OVERHEAD;
+}
@@ -0,0 +1,163 @@
+#ifndef FRAMING_H
+#define FRAMING_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "transport.h"
+
+/*
+ * Frame layout on the wire (multi-byte fields big-endian):
+ *
+ *   | SYNC 0xA5 0x5A | LENGTH (2) | TYPE (1) | PAYLOAD (LENGTH) | CRC (2) |
+ *
+ * The CRC is CRC-16/CCITT-FALSE over LENGTH, TYPE and PAYLOAD.
+ */
+
+#define FRAMING_SYNC_0 0xA5
+#define FRAMING_SYNC_1 0x5A
+#define FRAMING_HEADER_SIZE 5
+#define FRAMING_CRC_SIZE 2
+#define FRAMING_OVERHEAD (FRAMING_HEADER_SIZE + FRAMING_CRC_SIZE)
+#define FRAMING_MAX_PAYLOAD 1024
+
+#define FRAMING_WAIT_FOREVER TRANSPORT_WAIT_FOREVER
+
+typedef enum
+{
+    FRAME_HANDSHAKE = 0x01,
+    FRAME_DATA = 0x02,
+    FRAME_PUSH = 0x03,
+    FRAME_RESUME = 0x04
+} frame_type_t;
+
+typedef struct
+{
+    uint8_t type;
+    uint16_t length;
+    uint8_t *payload; // in the buffer of the parser that returned the frame
+} frame_t;
+
+typedef struct
+{
+    uint8_t buf[FRAMING_MAX_PAYLOAD + FRAMING_OVERHEAD]; // candidate frame, from its sync word
+    uint16_t len;
+    uint16_t consumed; // bytes of the last returned frame, dropped on the next call
+    frame_t frame;
+} framing_parser_t;
+
+/**
+ * @brief Open the link that framing_write() and framing_read() use.
+ *
+ * @param transport Link to the client
+ * @param params    Parameters handed to transport_open()
+ *
+ * @return true  If the link was opened
+ * @return false Otherwise
+ */
+bool framing_init(transport_t *transport, const char *params);
+
+/**
+ * @brief Reset a stream parser so it starts hunting for a sync word.
+ *
+ * @param parser Parser to reset
+ */
+void framing_parser_reset(framing_parser_t *parser);
+
+/**
+ * @brief Feed one received byte into a stream parser.
+ *
+ * Bytes outside a frame are skipped until the sync word is found. When a
+ * candidate has an oversized length or a bad CRC, only its first sync byte
+ * is dropped and the bytes after it are searched again, so a false sync
+ * word or a corrupted header does not swallow the frames that follow.
+ * Those frames are returned once the bytes that the false candidate
+ * claims for itself have arrived.
+ *
+ * @param parser Parser state
+ * @param byte   Next byte of the stream
+ *
+ * @return true  If a valid frame is complete, available in parser->frame until the next call
+ * @return false If more bytes are needed
+ */
+bool framing_parser_feed(framing_parser_t *parser, uint8_t byte);
+
+/**
+ * @brief Return a frame already complete in the bytes fed so far.
+ *
+ * Rejecting a candidate can leave whole frames behind it in the parser,
+ * call this until it returns false before feeding more bytes.
+ *
+ * @param parser Parser state
+ *
+ * @return true  If a valid frame is complete, available in parser->frame until the next call
+ * @return false If more bytes are needed
+ */
+bool framing_parser_next(framing_parser_t *parser);
+
+/**
+ * @brief Encode a frame into a buffer.
+ *
+ * @param type    Frame type
+ * @param payload Pointer to payload
+ * @param length  Payload length, at most FRAMING_MAX_PAYLOAD
+ * @param out     Destination, at least length + FRAMING_OVERHEAD bytes
+ *
+ * @return size_t Number of bytes written to out, 0 if length is too large
+ */
+size_t framing_encode(uint8_t type, const uint8_t *payload, size_t length, uint8_t *out);
+
+/**
+ * @brief Encode and transmit one frame.
+ *
+ * The payload is copied into the frame buffer, use framing_tx_payload()
+ * and framing_send() to build it there instead.
+ *
+ * @param type    Frame type
+ * @param payload Pointer to payload
+ * @param length  Payload length, at most FRAMING_MAX_PAYLOAD
+ *
+ * @return true  If the whole frame was written
+ * @return false If the payload is too large or transmission failed
+ */
+bool framing_write(uint8_t type, const uint8_t *payload, size_t length);
+
+/**
+ * @brief Payload region of the frame buffer that framing_send() transmits.
+ *
+ * Messages are built here in place, so they reach the link without being
+ * copied. Tasks sharing the link must hold their own lock from the first
+ * write to the region until framing_send() returns.
+ *
+ * @return uint8_t* FRAMING_MAX_PAYLOAD bytes, kept across calls
+ */
+uint8_t *framing_tx_payload(void);
+
+/**
+ * @brief Transmit the payload built in framing_tx_payload() as one frame.
+ *
+ * @param type   Frame type
+ * @param length Payload length, at most FRAMING_MAX_PAYLOAD
+ *
+ * @return true  If the whole frame was written
+ * @return false If the payload is too large or transmission failed
+ */
+bool framing_send(uint8_t type, size_t length);
+
+/**
+ * @brief Receive the next valid frame from the link.
+ *
+ * Bytes already received but not yet parsed are consumed first, so frames
+ * sent back-to-back are returned one per call without waiting on the link.
+ * The returned frame stays valid until the next call, and its payload
+ * may be modified in place, e.g. to decrypt it.
+ *
+ * @param frame   Set to the received frame
+ * @param wait_ms Longest time to wait for more bytes, or FRAMING_WAIT_FOREVER
+ *
+ * @return true  If a frame was received
+ * @return false If the link stayed idle for wait_ms
+ */
+bool framing_read(frame_t **frame, size_t wait_ms);
+
+#endif
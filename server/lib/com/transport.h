@@ -0,0 +1,111 @@
+#ifndef TRANSPORT_H
+#define TRANSPORT_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * Byte stream link to the client. The framing layer and the session only
+ * see this interface, the backend is chosen once at start-up. Every
+ * backend copies written bytes into its own buffer, so a write completes
+ * when it returns and the caller may reuse its buffer. Arrival of data is
+ * reported through poll and the timeout of read, so a task can wait on
+ * the link without reading from it.
+ */
+
+#define TRANSPORT_WAIT_FOREVER ((size_t)-1)
+
+typedef struct transport transport_t;
+
+typedef struct
+{
+    /* Claim the link, params is backend specific (e.g. the baud rate). */
+    bool (*open)(transport_t *transport, const char *params);
+    /* Wait up to wait_ms for data, then return what is buffered, up to length bytes. */
+    int (*read)(transport_t *transport, uint8_t *buf, size_t length, size_t wait_ms);
+    /* Queue all of data, blocking while the buffer of the backend is full. */
+    bool (*write)(transport_t *transport, const uint8_t *data, size_t length);
+    /* Wait up to wait_ms for data, return how many bytes read can return without waiting. */
+    size_t (*poll)(transport_t *transport, size_t wait_ms);
+} transport_ops_t;
+
+struct transport
+{
+    const transport_ops_t *ops;
+    void *ctx; // state of the backend, NULL for the ones driving a single peripheral
+};
+
+/* UART0 of the C6, params is the baud rate in decimal, at least 115200. */
+extern transport_t transport_uart;
+
+/*
+ * USB-Serial-JTAG of the C6, params is ignored as the link runs at USB
+ * full speed. The console must not use it as its secondary output
+ * (CONFIG_ESP_CONSOLE_SECONDARY_NONE), or logs end up in the frames.
+ */
+extern transport_t transport_usb_serial_jtag;
+
+/* Pseudo-terminal of the host build, params is ignored, the slave path is printed on open. */
+extern transport_t transport_pty;
+
+/**
+ * @brief Open a link.
+ *
+ * @param transport Link to open
+ * @param params    Backend specific parameters, null-terminated
+ *
+ * @return true  If the link is ready
+ * @return false If the parameters are invalid or the driver failed
+ */
+static inline bool transport_open(transport_t *transport, const char *params)
+{
+    return transport->ops->open(transport, params);
+}
+
+/**
+ * @brief Read the bytes already received, waiting for the first one.
+ *
+ * Message boundaries are left to the framing layer.
+ *
+ * @param transport Open link
+ * @param buf       Destination buffer
+ * @param length    Maximum number of bytes to read
+ * @param wait_ms   Longest time to wait for data, or TRANSPORT_WAIT_FOREVER
+ *
+ * @return int Number of bytes read, 0 on timeout
+ */
+static inline int transport_read(transport_t *transport, uint8_t *buf, size_t length, size_t wait_ms)
+{
+    return transport->ops->read(transport, buf, length, wait_ms);
+}
+
+/**
+ * @brief Write bytes to a link.
+ *
+ * @param transport Open link
+ * @param data      Bytes to send, may be reused once the call returns
+ * @param length    Number of bytes to send
+ *
+ * @return true  If all bytes were queued
+ * @return false Otherwise
+ */
+static inline bool transport_write(transport_t *transport, const uint8_t *data, size_t length)
+{
+    return transport->ops->write(transport, data, length);
+}
+
+/**
+ * @brief Wait for data without reading it.
+ *
+ * @param transport Open link
+ * @param wait_ms   Longest time to wait, 0 to only check, or TRANSPORT_WAIT_FOREVER
+ *
+ * @return size_t Number of bytes a read returns without waiting, 0 on timeout
+ */
+static inline size_t transport_poll(transport_t *transport, size_t wait_ms)
+{
+    return transport->ops->poll(transport, wait_ms);
+}
+
+#endif
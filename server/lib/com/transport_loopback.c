@@ -0,0 +1,167 @@
+#include <string.h>
+#include "transport_loopback.h"
+
+static bool pipe_init(transport_loopback_pipe_t *pipe);
+static size_t pipe_take(transport_loopback_pipe_t *pipe, uint8_t *buf, size_t length);
+static size_t pipe_put(transport_loopback_pipe_t *pipe, const uint8_t *data, size_t length);
+static size_t pipe_len(transport_loopback_pipe_t *pipe);
+static bool loopback_open(transport_t *transport, const char *params);
+static int loopback_read(transport_t *transport, uint8_t *buf, size_t length, size_t wait_ms);
+static bool loopback_write(transport_t *transport, const uint8_t *data, size_t length);
+static size_t loopback_poll(transport_t *transport, size_t wait_ms);
+static TickType_t ms_to_ticks(size_t wait_ms);
+
+static const transport_ops_t loopback_ops = {
+    .open = loopback_open,
+    .read = loopback_read,
+    .write = loopback_write,
+    .poll = loopback_poll,
+};
+
+bool transport_loopback_init(transport_loopback_t *loopback)
+{
+    loopback->device.transport.ops = &loopback_ops;
+    loopback->device.transport.ctx = &loopback->device;
+    loopback->device.rx = &loopback->to_device;
+    loopback->device.tx = &loopback->to_client;
+
+    loopback->client.transport.ops = &loopback_ops;
+    loopback->client.transport.ctx = &loopback->client;
+    loopback->client.rx = &loopback->to_client;
+    loopback->client.tx = &loopback->to_device;
+
+    return pipe_init(&loopback->to_device) && pipe_init(&loopback->to_client);
+}
+
+static bool pipe_init(transport_loopback_pipe_t *pipe)
+{
+    pipe->head = 0;
+    pipe->len = 0;
+    pipe->lock = xSemaphoreCreateMutex();
+    pipe->readable = xQueueCreate(1, sizeof(uint8_t));
+    pipe->writable = xQueueCreate(1, sizeof(uint8_t));
+
+    return (pipe->lock != NULL) && (pipe->readable != NULL) && (pipe->writable != NULL);
+}
+
+static size_t pipe_take(transport_loopback_pipe_t *pipe, uint8_t *buf, size_t length)
+{
+    uint8_t token = 0;
+
+    (void)xSemaphoreTake(pipe->lock, portMAX_DELAY);
+    size_t count = (pipe->len < length) ? pipe->len : length;
+    size_t first = TRANSPORT_LOOPBACK_SIZE - pipe->head;
+
+    first = (count < first) ? count : first;
+    memcpy(buf, pipe->data + pipe->head, first);
+    memcpy(buf + first, pipe->data, count - first);
+    pipe->head = (pipe->head + count) % TRANSPORT_LOOPBACK_SIZE;
+    pipe->len -= count;
+    (void)xSemaphoreGive(pipe->lock);
+
+    if (count > 0)
+    {
+        (void)xQueueOverwrite(pipe->writable, &token);
+    }
+
+    return count;
+}
+
+static size_t pipe_put(transport_loopback_pipe_t *pipe, const uint8_t *data, size_t length)
+{
+    uint8_t token = 0;
+
+    (void)xSemaphoreTake(pipe->lock, portMAX_DELAY);
+    size_t space = TRANSPORT_LOOPBACK_SIZE - pipe->len;
+    size_t count = (space < length) ? space : length;
+    size_t tail = (pipe->head + pipe->len) % TRANSPORT_LOOPBACK_SIZE;
+    size_t first = TRANSPORT_LOOPBACK_SIZE - tail;
+
+    first = (count < first) ? count : first;
+    memcpy(pipe->data + tail, data, first);
+    memcpy(pipe->data, data + first, count - first);
+    pipe->len += count;
+    (void)xSemaphoreGive(pipe->lock);
+
+    if (count > 0)
+    {
+        (void)xQueueOverwrite(pipe->readable, &token);
+    }
+
+    return count;
+}
+
+static size_t pipe_len(transport_loopback_pipe_t *pipe)
+{
+    (void)xSemaphoreTake(pipe->lock, portMAX_DELAY);
+    size_t len = pipe->len;
+    (void)xSemaphoreGive(pipe->lock);
+
+    return len;
+}
+
+static bool loopback_open(transport_t *transport, const char *params)
+{
+    (void)params;
+
+    return (transport->ctx != NULL);
+}
+
+/*
+ * A signal may be left over from data that was already taken, so the
+ * pipe is checked again after every wake-up.
+ */
+static int loopback_read(transport_t *transport, uint8_t *buf, size_t length, size_t wait_ms)
+{
+    transport_loopback_end_t *end = transport->ctx;
+    TickType_t wait = ms_to_ticks(wait_ms);
+    uint8_t token;
+
+    size_t count = pipe_take(end->rx, buf, length);
+    while ((count == 0) && (pdTRUE == xQueueReceive(end->rx->readable, &token, wait)))
+    {
+        count = pipe_take(end->rx, buf, length);
+    }
+
+    return (int)count;
+}
+
+static bool loopback_write(transport_t *transport, const uint8_t *data, size_t length)
+{
+    transport_loopback_end_t *end = transport->ctx;
+    size_t written = 0;
+    uint8_t token;
+
+    while (written < length)
+    {
+        size_t count = pipe_put(end->tx, data + written, length - written);
+        written += count;
+
+        if ((count == 0) && (pdTRUE != xQueueReceive(end->tx->writable, &token, portMAX_DELAY)))
+        {
+            break;
+        }
+    }
+
+    return (written == length);
+}
+
+static size_t loopback_poll(transport_t *transport, size_t wait_ms)
+{
+    transport_loopback_end_t *end = transport->ctx;
+    TickType_t wait = ms_to_ticks(wait_ms);
+    uint8_t token;
+
+    size_t available = pipe_len(end->rx);
+    while ((available == 0) && (pdTRUE == xQueueReceive(end->rx->readable, &token, wait)))
+    {
+        available = pipe_len(end->rx);
+    }
+
+    return available;
+}
+
+static TickType_t ms_to_ticks(size_t wait_ms)
+{
+    return (wait_ms == TRANSPORT_WAIT_FOREVER) ? portMAX_DELAY : pdMS_TO_TICKS(wait_ms);
+}
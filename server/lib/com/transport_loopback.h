@@ -0,0 +1,55 @@
+#ifndef TRANSPORT_LOOPBACK_H
+#define TRANSPORT_LOOPBACK_H
+
+#include "transport.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+
+/*
+ * In-memory link between two ends in the same program, e.g. the session
+ * in one task and a client in another. It runs the protocol and its
+ * crypto without a UART in the way, so their throughput can be measured
+ * on the host as well as on the target.
+ */
+
+#define TRANSPORT_LOOPBACK_SIZE 4096
+
+typedef struct
+{
+    uint8_t data[TRANSPORT_LOOPBACK_SIZE];
+    size_t head; // oldest byte
+    size_t len;
+    SemaphoreHandle_t lock;
+    QueueHandle_t readable; // signalled after every write
+    QueueHandle_t writable; // signalled after every read
+} transport_loopback_pipe_t;
+
+typedef struct
+{
+    transport_t transport;
+    transport_loopback_pipe_t *rx;
+    transport_loopback_pipe_t *tx;
+} transport_loopback_end_t;
+
+typedef struct
+{
+    transport_loopback_pipe_t to_device;
+    transport_loopback_pipe_t to_client;
+    transport_loopback_end_t device; // hand &device.transport to the session
+    transport_loopback_end_t client;
+} transport_loopback_t;
+
+/**
+ * @brief Connect the two ends of a loopback link.
+ *
+ * Both ends still have to be opened, with any params, before use.
+ *
+ * @param loopback Link to set up, must outlive both ends
+ *
+ * @return true  If the link was set up
+ * @return false If its locks could not be created
+ */
+bool transport_loopback_init(transport_loopback_t *loopback);
+
+#endif
@@ -0,0 +1,162 @@
+#include <stdlib.h>
+#include "driver/uart.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "transport.h"
+
+#define UART_PORT UART_NUM_0
+
+/* Room for a backlog of pipelined request frames. */
+#define UART_BUF_SIZE (16 * SOC_UART_FIFO_LEN)
+
+#define LOWEST_SPEED 115200
+
+#define UART_EVENT_QUEUE_SIZE 16
+
+/* Idle time, in symbols, after which the driver reports buffered data. */
+#define UART_RX_TIMEOUT_SYMBOLS 2
+
+/* FIFO level at which the driver reports data without waiting for idle. */
+#define UART_RX_FULL_THRESHOLD (SOC_UART_FIFO_LEN / 2)
+
+static QueueHandle_t uart_queue = NULL;
+
+static bool uart_open(transport_t *transport, const char *params);
+static int uart_read(transport_t *transport, uint8_t *buf, size_t length, size_t wait_ms);
+static bool uart_write(transport_t *transport, const uint8_t *data, size_t length);
+static size_t uart_poll(transport_t *transport, size_t wait_ms);
+static int read_events(uint8_t *buf, size_t length, TickType_t first_wait, TickType_t wait);
+static bool wait_event(TickType_t wait);
+static TickType_t ms_to_ticks(size_t wait_ms);
+
+static const transport_ops_t uart_ops = {
+    .open = uart_open,
+    .read = uart_read,
+    .write = uart_write,
+    .poll = uart_poll,
+};
+
+transport_t transport_uart = {.ops = &uart_ops, .ctx = NULL};
+
+static bool uart_open(transport_t *transport, const char *params)
+{
+    (void)transport;
+
+    bool status = true;
+
+    int speed = atoi(params);
+
+    if (speed < LOWEST_SPEED)
+    {
+        status = false;
+    }
+    else
+    {
+        uart_config_t uart_config = {
+            .baud_rate = speed,
+            .data_bits = UART_DATA_8_BITS,
+            .parity = UART_PARITY_DISABLE,
+            .stop_bits = UART_STOP_BITS_1,
+            .flow_ctrl = UART_HW_FLOWCTRL_DISABLE};
+
+        ESP_ERROR_CHECK(uart_driver_install(UART_PORT, UART_BUF_SIZE, UART_BUF_SIZE, UART_EVENT_QUEUE_SIZE, &uart_queue, 0));
+        ESP_ERROR_CHECK(uart_param_config(UART_PORT, &uart_config));
+        ESP_ERROR_CHECK(uart_set_pin(UART_PORT, UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE));
+        ESP_ERROR_CHECK(uart_set_rx_timeout(UART_PORT, UART_RX_TIMEOUT_SYMBOLS));
+        ESP_ERROR_CHECK(uart_set_rx_full_threshold(UART_PORT, UART_RX_FULL_THRESHOLD));
+    }
+
+    return status;
+}
+
+static int uart_read(transport_t *transport, uint8_t *buf, size_t length, size_t wait_ms)
+{
+    (void)transport;
+
+    return read_events(buf, length, ms_to_ticks(wait_ms), 0);
+}
+
+static bool uart_write(transport_t *transport, const uint8_t *data, size_t length)
+{
+    (void)transport;
+
+    return (length == uart_write_bytes(UART_PORT, data, length));
+}
+
+static size_t uart_poll(transport_t *transport, size_t wait_ms)
+{
+    (void)transport;
+
+    size_t available = 0;
+    TickType_t wait = ms_to_ticks(wait_ms);
+
+    (void)uart_get_buffered_data_len(UART_PORT, &available);
+    while ((available == 0) && wait_event(wait))
+    {
+        (void)uart_get_buffered_data_len(UART_PORT, &available);
+    }
+
+    return available;
+}
+
+/*
+ * Collects up to length bytes, sleeping on the driver event queue between
+ * chunks so the caller is woken by the RX-full/RX-timeout interrupt rather
+ * than by a polling delay. Returns as soon as length bytes have arrived or
+ * no further event comes within wait after the first byte.
+ */
+static int read_events(uint8_t *buf, size_t length, TickType_t first_wait, TickType_t wait)
+{
+    size_t received = 0;
+    bool waiting = true;
+
+    while ((received < length) && waiting)
+    {
+        size_t available = 0;
+        (void)uart_get_buffered_data_len(UART_PORT, &available);
+
+        if (available > 0)
+        {
+            size_t chunk = (available < (length - received)) ? available : (length - received);
+            int count = uart_read_bytes(UART_PORT, buf + received, chunk, 0);
+            if (count > 0)
+            {
+                received += count;
+            }
+        }
+        else if (!wait_event((received == 0) ? first_wait : wait))
+        {
+            // Idle, or bytes were dropped and what was collected is no longer a whole message
+            waiting = false;
+        }
+    }
+
+    return received;
+}
+
+/* Returns false on timeout and after an overflow, which flushes the input. */
+static bool wait_event(TickType_t wait)
+{
+    bool status = false;
+    uart_event_t event;
+
+    if (pdTRUE == xQueueReceive(uart_queue, &event, wait))
+    {
+        if ((event.type == UART_FIFO_OVF) || (event.type == UART_BUFFER_FULL))
+        {
+            uart_flush_input(UART_PORT);
+            xQueueReset(uart_queue);
+        }
+        else
+        {
+            status = true;
+        }
+    }
+
+    return status;
+}
+
+static TickType_t ms_to_ticks(size_t wait_ms)
+{
+    return (wait_ms == TRANSPORT_WAIT_FOREVER) ? portMAX_DELAY : pdMS_TO_TICKS(wait_ms);
+}
@@ -0,0 +1,90 @@
+#include <string.h>
+#include "driver/usb_serial_jtag.h"
+#include "freertos/FreeRTOS.h"
+#include "transport.h"
+
+/* Room for a backlog of pipelined request frames, as on the UART. */
+#define USJ_BUF_SIZE 2048
+
+/* Bytes taken from the driver by poll, handed out by the next read. */
+#define LOOKAHEAD_SIZE 64
+
+static uint8_t lookahead[LOOKAHEAD_SIZE];
+static size_t lookahead_len = 0;
+
+static bool usj_open(transport_t *transport, const char *params);
+static int usj_read(transport_t *transport, uint8_t *buf, size_t length, size_t wait_ms);
+static bool usj_write(transport_t *transport, const uint8_t *data, size_t length);
+static size_t usj_poll(transport_t *transport, size_t wait_ms);
+static TickType_t ms_to_ticks(size_t wait_ms);
+
+static const transport_ops_t usj_ops = {
+    .open = usj_open,
+    .read = usj_read,
+    .write = usj_write,
+    .poll = usj_poll,
+};
+
+transport_t transport_usb_serial_jtag = {.ops = &usj_ops, .ctx = NULL};
+
+static bool usj_open(transport_t *transport, const char *params)
+{
+    (void)transport;
+    (void)params;
+
+    usb_serial_jtag_driver_config_t config = {
+        .tx_buffer_size = USJ_BUF_SIZE,
+        .rx_buffer_size = USJ_BUF_SIZE,
+    };
+
+    lookahead_len = 0;
+
+    return (ESP_OK == usb_serial_jtag_driver_install(&config));
+}
+
+static int usj_read(transport_t *transport, uint8_t *buf, size_t length, size_t wait_ms)
+{
+    (void)transport;
+
+    size_t received = (lookahead_len < length) ? lookahead_len : length;
+
+    memcpy(buf, lookahead, received);
+    lookahead_len -= received;
+    memmove(lookahead, lookahead + received, lookahead_len);
+
+    if (received < length)
+    {
+        // Only wait when nothing was buffered, then take whatever else is already there
+        int count = usb_serial_jtag_read_bytes(buf + received, length - received,
+                                               (received == 0) ? ms_to_ticks(wait_ms) : 0);
+        received += (count > 0) ? (size_t)count : 0;
+    }
+
+    return (int)received;
+}
+
+static bool usj_write(transport_t *transport, const uint8_t *data, size_t length)
+{
+    (void)transport;
+
+    return (length == (size_t)usb_serial_jtag_write_bytes(data, length, portMAX_DELAY));
+}
+
+/* The driver cannot report its buffered length, so poll reads ahead into a small buffer. */
+static size_t usj_poll(transport_t *transport, size_t wait_ms)
+{
+    (void)transport;
+
+    if (lookahead_len == 0)
+    {
+        int count = usb_serial_jtag_read_bytes(lookahead, sizeof(lookahead), ms_to_ticks(wait_ms));
+        lookahead_len = (count > 0) ? (size_t)count : 0;
+    }
+
+    return lookahead_len;
+}
+
+static TickType_t ms_to_ticks(size_t wait_ms)
+{
+    return (wait_ms == TRANSPORT_WAIT_FOREVER) ? portMAX_DELAY : pdMS_TO_TICKS(wait_ms);
+}
@@ -0,0 +1,45 @@
+#include "replay_window.h"
+
+void replay_window_reset(replay_window_t *window)
+{
+    window->top = 0;
+    window->bitmap = 0;
+}
+
+bool replay_window_check(const replay_window_t *window, uint32_t seq)
+{
+    bool status = false;
+
+    if (seq >= window->top)
+    {
+        status = true;
+    }
+    else
+    {
+        uint64_t offset = window->top - 1 - seq;
+
+        if (offset < REPLAY_WINDOW_SIZE)
+        {
+            status = ((window->bitmap >> offset) & 1ULL) == 0;
+        }
+    }
+
+    return status;
+}
+
+void replay_window_update(replay_window_t *window, uint32_t seq)
+{
+    if (seq >= window->top)
+    {
+        uint64_t shift = (uint64_t)seq + 1 - window->top;
+
+        // Shifting a 64-bit value by 64 or more is undefined
+        window->bitmap = (shift < REPLAY_WINDOW_SIZE) ? (window->bitmap << shift) : 0;
+        window->bitmap |= 1ULL;
+        window->top = (uint64_t)seq + 1;
+    }
+    else
+    {
+        window->bitmap |= 1ULL << (window->top - 1 - seq);
+    }
+}
@@ -0,0 +1,53 @@
+#ifndef REPLAY_WINDOW_H
+#define REPLAY_WINDOW_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define REPLAY_WINDOW_SIZE 64
+
+/*
+ * Anti-replay window over message sequence numbers, as in IPsec (RFC 4303).
+ * Bit i of the bitmap marks sequence number top - 1 - i as received, so
+ * messages may arrive out of order as long as they are within
+ * REPLAY_WINDOW_SIZE of the highest one received.
+ */
+typedef struct
+{
+    uint64_t top; // highest sequence number received + 1, 0 if none
+    uint64_t bitmap;
+} replay_window_t;
+
+/**
+ * @brief Forget every received sequence number.
+ *
+ * @param window Window to reset
+ */
+void replay_window_reset(replay_window_t *window);
+
+/**
+ * @brief Check whether a sequence number may be accepted.
+ *
+ * Does not change the window, so it can be called before the message
+ * is authenticated.
+ *
+ * @param window Window to check against
+ * @param seq    Sequence number of the message
+ *
+ * @return true  If seq is new and not older than the window
+ * @return false If seq was already received or is too old
+ */
+bool replay_window_check(const replay_window_t *window, uint32_t seq);
+
+/**
+ * @brief Mark a sequence number as received.
+ *
+ * Only call this once the message has been authenticated and
+ * replay_window_check() accepted it.
+ *
+ * @param window Window to update
+ * @param seq    Sequence number of the message
+ */
+void replay_window_update(replay_window_t *window, uint32_t seq);
+
+#endif
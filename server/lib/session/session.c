@@ -1,34 +1,82 @@
 #include <string.h>
 #include "session.h"
 #include <sys/time.h>
-#include "communication.h"
-#include <stdio.h>
+#include "framing.h"
+#include "replay_window.h"
+#include "session_crypto.h"
 #include <esp_random.h>
 #include <bootloader_random.h>
 #include <psa/crypto.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
 
 /* Size in bytes */
-#define AES_KEY_SIZE 32
+#define AES_KEY_SIZE SESSION_CRYPTO_KEY_SIZE
 #define SESSION_ID_SIZE 8
-#define IV_SIZE 12
-#define TAG_SIZE 16
+#define IV_SIZE SESSION_CRYPTO_IV_SIZE
+#define TAG_SIZE SESSION_CRYPTO_TAG_SIZE
 #define RAND_SIZE 8
 #define TIME_STAMP_SIZE 8
+#define SEQ_SIZE 4
+#define COUNTER_SIZE 4
+#define HMAC_SIZE 32
 #define REQUEST_SIZE 1
 #define STATUS_SIZE 1
-#define MAX_PAYLOAD_SIZE_TX (sizeof(float) + TIME_STAMP_SIZE)
-#define MAX_PAYLOAD_SIZE_RX (AES_KEY_SIZE + RAND_SIZE)
+#define COUNT_SIZE 1
+#define SUBSCRIPTION_ARGS_SIZE 4
+#define PIXELS_HEADER_SIZE 3
+#define PALETTE_ENTRY_SIZE 3
+#define RUN_SIZE 2
+#define CHUNK_HEADER_SIZE 4
+#define GENERATION_SIZE 4
+#define RESUMPTION_SECRET_SIZE 32
+#define CLIENT_RAND_SIZE 16
+#define SUITE_SIZE 1
+#define HANDSHAKE_1_HEADER_SIZE (AES_KEY_SIZE + RAND_SIZE + COUNT_SIZE)
+#define TICKET_PLAINTEXT_SIZE (GENERATION_SIZE + TIME_STAMP_SIZE + SUITE_SIZE + RESUMPTION_SECRET_SIZE)
+#define TICKET_SIZE (IV_SIZE + TICKET_PLAINTEXT_SIZE + TAG_SIZE)
+#define RESUMPTION_SIZE (RESUMPTION_SECRET_SIZE + TICKET_SIZE)
+#define RESUME_REQUEST_SIZE (TICKET_SIZE + CLIENT_RAND_SIZE + IV_SIZE + TIME_STAMP_SIZE + TAG_SIZE)
+#define BATCH_RESULT_MAX_SIZE (REQUEST_SIZE + STATUS_SIZE + sizeof(float))
+#define BATCH_ARGS_SIZE (COUNT_SIZE + SESSION_BATCH_MAX_COMMANDS)
+#define MAX_ARGS_SIZE (BATCH_ARGS_SIZE > SESSION_PIXELS_MAX_SIZE ? BATCH_ARGS_SIZE \
+                                                                 : SESSION_PIXELS_MAX_SIZE)
+#define MAX_PAYLOAD_SIZE_RX (REQUEST_SIZE + TIME_STAMP_SIZE + MAX_ARGS_SIZE)
+#define BATCH_PAYLOAD_SIZE (STATUS_SIZE + TIME_STAMP_SIZE + COUNT_SIZE + \
+                            SESSION_BATCH_MAX_COMMANDS * BATCH_RESULT_MAX_SIZE)
+#define SAMPLES_PAYLOAD_SIZE (STATUS_SIZE + TIME_STAMP_SIZE + CHUNK_HEADER_SIZE + \
+                              SESSION_SAMPLES_MAX_CHUNK)
+#define MAX_PAYLOAD_SIZE_TX (BATCH_PAYLOAD_SIZE > SAMPLES_PAYLOAD_SIZE ? BATCH_PAYLOAD_SIZE \
+                                                                       : SAMPLES_PAYLOAD_SIZE)
+#define DATA_AAD_SIZE (SESSION_ID_SIZE + SEQ_SIZE)
+#define DATA_HEADER_SIZE (COUNTER_SIZE + SEQ_SIZE)
+
+// Data frames are built in place in the frame buffer of the framing layer
+_Static_assert(DATA_HEADER_SIZE + MAX_PAYLOAD_SIZE_TX + TAG_SIZE <= FRAMING_MAX_PAYLOAD,
+               "largest data frame does not fit the frame buffer");
 
 /* Size in bits */
 #define BYTE_SIZE 8
-#define UART_WAIT_TICKS 200
+#define HANDSHAKE_WAIT_MS 200
 #define SESSION_TIMEOUT_US (60ULL * 1000000ULL)
+#define TICKET_LIFETIME_US (60ULL * 60ULL * 1000000ULL)
 
 typedef struct
 {
     bool active;
     uint8_t id[SESSION_ID_SIZE];
-    uint64_t latest_msg; // timestamp from the latest msg
+    session_suite_t suite; // AEAD of the data frames, chosen in the handshake
+    uint64_t latest_msg;  // newest timestamp received
+    uint64_t request_ts;  // timestamp of the request being answered
+    uint32_t request_seq; // sequence number of the request being answered
+    replay_window_t replay; // sequence numbers already received
+    uint8_t iv_c2d[IV_SIZE]; // IV base of client to device data frames
+    uint8_t iv_d2c[IV_SIZE]; // IV base of device to client data frames
+    uint32_t tx_counter;     // counter of the last device to client data frame
+    const uint8_t *args; // arguments following the request timestamp, in the received frame
+    size_t args_len;
+    bool subscribed;   // pushes allowed until UNSUBSCRIBE_TEMP or close
+    uint32_t push_seq; // sequence number of the SUBSCRIBE_TEMP request
 } session_ctx_t;
 
 typedef enum
@@ -38,42 +86,66 @@ typedef enum
     SESSION_OK = 1
 } session_status_t;
 
-typedef union
-{
-    float f;
-    uint8_t b[sizeof(float)];
-} float_bytes_t;
-
 static session_ctx_t session;
 static session_status_t session_status;
-static psa_key_handle_t gcm_key = 0;
+static session_crypto_ctx_t psk_aead;     // handshakes, keyed once from HSECRET
+static session_crypto_ctx_t session_aead; // data frames of the current session
+static session_crypto_ctx_t ticket_aead;  // key never leaves the device
+static uint32_t ticket_generation = 0;  // only the latest ticket is accepted
+static bool ticket_live = false;        // and only once
 static uint8_t iv[IV_SIZE];
-static uint8_t tx_buf[IV_SIZE + MAX_PAYLOAD_SIZE_TX + TAG_SIZE];
-static uint8_t rx_buf[IV_SIZE + MAX_PAYLOAD_SIZE_RX + TAG_SIZE];
+static SemaphoreHandle_t session_lock = NULL;
 
-static bool gcm_init_psa(const uint8_t *key);
+static bool psk_init(void);
 static void set_rtc_from_timestamp(uint64_t timestamp_us);
-static bool handle_handshake_1(uint8_t *key, uint8_t *session_id);
-static bool handle_handshake_2(uint8_t *key, uint8_t *session_id);
-static void hex_to_bytes(const char *hex, uint8_t *out, size_t len);
+static bool ticket_key_init(void);
+static bool issue_ticket(uint8_t *resumption);
+static bool open_ticket(uint8_t *ticket, uint8_t *secret, session_suite_t *suite);
+static bool hmac_sha256(const uint8_t *key, size_t key_len, const uint8_t *msg, size_t msg_len, uint8_t *mac);
+static bool derive_iv_bases(const uint8_t *key);
+static bool handle_resume(frame_t *frame);
+static bool handle_handshake_1(frame_t *frame, uint8_t *key, uint8_t *session_id, session_suite_t *suite);
+static bool handle_handshake_2(uint8_t *key, uint8_t *session_id, session_suite_t suite);
+static bool hex_to_bytes(const char *hex, uint8_t *out, size_t len);
+static int hex_digit(char c);
 static inline void write_be64(uint8_t *buf, uint64_t v);
-static bool encrypt(uint8_t *plaintext, uint8_t *cipher, size_t msg_len, uint8_t *AAD, size_t AAD_len);
-static bool decrypt(uint8_t *cipher, uint8_t *plaintext, size_t cipher_len, uint8_t *AAD, size_t AAD_len);
-static bool send(uint8_t *cipher, size_t len);
-static bool read(uint8_t *cipher, size_t len);
-static bool read_timeout(uint8_t *cipher, size_t len_cipher, size_t wait_ml);
-
-bool session_init()
+static inline void write_be32(uint8_t *buf, uint32_t v);
+static inline uint32_t read_be32(const uint8_t *buf);
+static inline uint64_t read_be64(const uint8_t *buf);
+static uint64_t now_us(void);
+static inline uint16_t read_be16(const uint8_t *buf);
+static inline void write_be16(uint8_t *buf, uint16_t v);
+static void data_aad(uint8_t *aad, uint32_t seq);
+static void data_iv(const uint8_t *base, uint32_t counter);
+static bool random_iv(void);
+static bool encrypt(uint8_t *plaintext, uint8_t *cipher, size_t msg_len, const uint8_t *AAD, size_t AAD_len);
+static bool decrypt(uint8_t *cipher, uint8_t *plaintext, size_t cipher_len, const uint8_t *AAD, size_t AAD_len);
+static bool send_handshake(uint8_t type, size_t offset, size_t msg_len, const uint8_t *AAD, size_t AAD_len);
+static uint8_t *data_plaintext(void);
+static bool send_data(size_t msg_len);
+static bool send_sequenced(uint8_t type, uint32_t seq, size_t msg_len);
+static bool read_data(uint32_t *seq, uint8_t **cipher, size_t *len_cipher);
+static bool batch_is_valid(void);
+static bool subscription_is_valid(void);
+static bool pixels_is_valid(void);
+static uint32_t pixels_end(void);
+
+bool session_init(transport_t *transport, const char *params)
 {
     bool status = false;
     session.active = false;
     memset(session.id, 0, SESSION_ID_SIZE);
 
-    if (communication_init(SPEED))
+    session_lock = xSemaphoreCreateRecursiveMutex();
+
+    if ((session_lock != NULL) && framing_init(transport, params))
     {
         if (psa_crypto_init() == PSA_SUCCESS)
         {
-            status = true;
+            session_crypto_init(&psk_aead);
+            session_crypto_init(&session_aead);
+            session_crypto_init(&ticket_aead);
+            status = psk_init() && ticket_key_init();
         }
     }
 
@@ -84,31 +156,46 @@ bool session_close(void)
 {
     bool status = false;
 
-    uint8_t plaintext[STATUS_SIZE + TIME_STAMP_SIZE];
-    uint8_t cipher[STATUS_SIZE + TIME_STAMP_SIZE + TAG_SIZE];
+    xSemaphoreTakeRecursive(session_lock, portMAX_DELAY);
 
+    uint8_t *plaintext = data_plaintext();
     size_t offset = 0;
     plaintext[offset] = session_status;
     offset += STATUS_SIZE;
-    uint8_t timestamp_b[TIME_STAMP_SIZE];
-    write_be64(timestamp_b, session.latest_msg);
-    memcpy(plaintext + offset, timestamp_b, TIME_STAMP_SIZE);
+    write_be64(plaintext + offset, session.request_ts);
+    offset += TIME_STAMP_SIZE;
 
-    if (encrypt(plaintext, cipher, sizeof(plaintext), session.id, SESSION_ID_SIZE))
+    // The ticket lets the client resume with a single round trip
+    if (issue_ticket(plaintext + offset))
     {
-        if (send(cipher, sizeof(cipher)))
-        {
-            status = true;
-        }
+        offset += RESUMPTION_SIZE;
+    }
+
+    // Encrypted in place, so only an unsent response leaves the resumption secret in clear
+    status = send_data(offset);
+    if (!status)
+    {
+        memset(plaintext, 0, offset);
     }
 
     session.active = false;
     memset(session.id, 0, SESSION_ID_SIZE);
+    session.suite = SESSION_SUITE_NONE;
     memset(&session.latest_msg, 0, TIME_STAMP_SIZE);
+    session.request_ts = 0;
+    replay_window_reset(&session.replay);
+    memset(session.iv_c2d, 0, IV_SIZE);
+    memset(session.iv_d2c, 0, IV_SIZE);
+    session.tx_counter = 0;
+    session.request_seq = 0;
+    session.args_len = 0;
+    session.subscribed = false;
+    session.push_seq = 0;
     memset(iv, 0, IV_SIZE);
 
-    psa_destroy_key(gcm_key);
-    gcm_key = 0;
+    session_crypto_clear(&session_aead);
+
+    xSemaphoreGiveRecursive(session_lock);
 
     return status;
 }
@@ -121,15 +208,31 @@ bool session_is_active(void)
 session_request_t session_get_request(void)
 {
     session_request_t req = INVALID;
-    uint8_t plaintext[REQUEST_SIZE + TIME_STAMP_SIZE] = {0};
-    uint8_t cipher[REQUEST_SIZE + TIME_STAMP_SIZE + TAG_SIZE] = {0};
+    uint8_t *plaintext = NULL; // decrypted in place in the received frame
+    size_t cipher_len = 0;
+    uint8_t aad[DATA_AAD_SIZE];
+    uint32_t seq = 0;
 
-    if (read(cipher, sizeof(cipher)))
+    if (read_data(&seq, &plaintext, &cipher_len) &&
+        (cipher_len >= REQUEST_SIZE + TIME_STAMP_SIZE + TAG_SIZE))
     {
-        if (decrypt(cipher, plaintext, sizeof(cipher), session.id, SESSION_ID_SIZE))
+        // The telemetry task encrypts with the same key and IV buffer
+        xSemaphoreTakeRecursive(session_lock, portMAX_DELAY);
+
+        data_iv(session.iv_c2d, seq);
+        data_aad(aad, seq);
+
+        // The window is checked before and updated only after authentication
+        if (replay_window_check(&session.replay, seq) &&
+            decrypt(plaintext, plaintext, cipher_len, aad, sizeof(aad)))
         {
+            replay_window_update(&session.replay, seq);
+            session.request_seq = seq;
             req = (session_request_t)plaintext[0];
 
+            session.args = plaintext + REQUEST_SIZE + TIME_STAMP_SIZE;
+            session.args_len = cipher_len - TAG_SIZE - REQUEST_SIZE - TIME_STAMP_SIZE;
+
             uint64_t time_stamp = 0;
             for (int i = 0; i < TIME_STAMP_SIZE; i++)
             {
@@ -137,32 +240,53 @@ session_request_t session_get_request(void)
                              plaintext[REQUEST_SIZE + i];
             }
 
-            if (time_stamp < session.latest_msg)
+            // Pipelined requests may arrive out of order, so an older
+            // timestamp is fine and only a newer one can expire the session
+            bool expired = (time_stamp > session.latest_msg) &&
+                           ((time_stamp - session.latest_msg) > SESSION_TIMEOUT_US);
+
+            session.request_ts = time_stamp;
+            if (time_stamp > session.latest_msg)
             {
-                req = INVALID;
+                session.latest_msg = time_stamp;
             }
-            else if ((time_stamp - session.latest_msg) > SESSION_TIMEOUT_US)
+
+            if (expired)
             {
-                session.latest_msg = time_stamp;
                 session_status = SESSION_EXPIRED;
                 session_close();
                 req = INVALID;
             }
             else if (req == CLOSE_SESSION)
             {
-                session.latest_msg = time_stamp;
                 session_status = SESSION_OK;
                 session_close();
             }
             else
             {
-                session.latest_msg = time_stamp;
+                if (((req == BATCH) && !batch_is_valid()) ||
+                    ((req == SUBSCRIBE_TEMP) && !subscription_is_valid()) ||
+                    ((req == SET_PIXELS) && !pixels_is_valid()))
+                {
+                    req = INVALID;
+                }
+                else if (req == SUBSCRIBE_TEMP)
+                {
+                    session.subscribed = true;
+                    session.push_seq = seq;
+                }
+                else if (req == UNSUBSCRIBE_TEMP)
+                {
+                    session.subscribed = false;
+                }
             }
         }
         else
         {
             req = INVALID;
         }
+
+        xSemaphoreGiveRecursive(session_lock);
     }
     else
     {
@@ -174,81 +298,177 @@ session_request_t session_get_request(void)
 bool session_establish(void)
 {
     bool status = false;
-    uint8_t psa_key[AES_KEY_SIZE];
+    uint8_t session_key[AES_KEY_SIZE];
     uint8_t session_id[SESSION_ID_SIZE] = {0};
+    session_suite_t suite = SESSION_SUITE_NONE;
+    frame_t *frame;
 
-    hex_to_bytes(HSECRET, psa_key, AES_KEY_SIZE);
-
-    if (gcm_init_psa(psa_key))
+    if (framing_read(&frame, FRAMING_WAIT_FOREVER))
     {
-        if (handle_handshake_1(psa_key, session_id))
+        if (frame->type == FRAME_RESUME)
         {
-            if (handle_handshake_2(psa_key, session_id))
+            status = handle_resume(frame);
+        }
+        else
+        {
+            if (handle_handshake_1(frame, session_key, session_id, &suite))
             {
-                status = true;
-                session_status = SESSION_OK;
+                status = handle_handshake_2(session_key, session_id, suite);
             }
         }
+
+        if (status)
+        {
+            session_status = SESSION_OK;
+        }
     }
 
+    memset(session_key, 0, sizeof(session_key));
+
     return status;
 }
 
-static bool handle_handshake_1(uint8_t *key, uint8_t *session_id)
+/*
+ * Resume request: | TICKET | CLIENT_RAND (16) | IV | TIME_STAMP | TAG |
+ * Resume response: | IV | SESSION_ID | TIME_STAMP | TAG |
+ *
+ * Both are encrypted with HMAC-SHA256(resumption secret, CLIENT_RAND) and
+ * authenticate CLIENT_RAND, so the client proves it holds the secret that
+ * came with the ticket. The resumed session keeps the suite of the session
+ * that issued the ticket.
+ */
+static bool handle_resume(frame_t *frame)
 {
     bool status = false;
-    uint8_t plaintext[AES_KEY_SIZE + SESSION_ID_SIZE];
-    uint8_t cipher_received[AES_KEY_SIZE + SESSION_ID_SIZE + TAG_SIZE];
-    uint8_t cipher_send[SESSION_ID_SIZE + TAG_SIZE];
-    uint8_t rand[RAND_SIZE];
+    uint8_t secret[RESUMPTION_SECRET_SIZE];
+    uint8_t key[AES_KEY_SIZE];
+    uint8_t session_id[SESSION_ID_SIZE];
+    session_suite_t suite = SESSION_SUITE_NONE;
 
-    if (read(cipher_received, sizeof(cipher_received)))
+    if ((frame->length == RESUME_REQUEST_SIZE) && open_ticket(frame->payload, secret, &suite))
     {
-        if (decrypt(cipher_received, plaintext, sizeof(cipher_received), session_id, SESSION_ID_SIZE))
-        {
-            memcpy(key, plaintext, AES_KEY_SIZE);
-            memcpy(rand, plaintext + AES_KEY_SIZE, RAND_SIZE);
+        const uint8_t *client_rand = frame->payload + TICKET_SIZE;
+        uint8_t *timestamp = frame->payload + TICKET_SIZE + CLIENT_RAND_SIZE + IV_SIZE;
+        memcpy(iv, client_rand + CLIENT_RAND_SIZE, IV_SIZE);
 
-            if (gcm_init_psa(key))
+        if (hmac_sha256(secret, RESUMPTION_SECRET_SIZE, client_rand, CLIENT_RAND_SIZE, key) &&
+            session_crypto_set_key(&session_aead, suite, key) && derive_iv_bases(key))
+        {
+            if (decrypt(timestamp, timestamp, TIME_STAMP_SIZE + TAG_SIZE, client_rand, CLIENT_RAND_SIZE))
             {
+                uint64_t timestamp_us = read_be64(timestamp);
+
+                // Only a client holding the secret spends the ticket, not a replay with a bad binder
+                ticket_live = false;
+
                 if (psa_generate_random(session_id, SESSION_ID_SIZE) == PSA_SUCCESS)
                 {
-                    if (encrypt(session_id, cipher_send, SESSION_ID_SIZE, rand, RAND_SIZE))
+                    uint8_t *reply = framing_tx_payload() + IV_SIZE;
+
+                    set_rtc_from_timestamp(timestamp_us);
+                    memcpy(reply, session_id, SESSION_ID_SIZE);
+                    memcpy(reply + SESSION_ID_SIZE, timestamp, TIME_STAMP_SIZE);
+
+                    if (send_handshake(FRAME_RESUME, 0, SESSION_ID_SIZE + TIME_STAMP_SIZE, client_rand, CLIENT_RAND_SIZE))
                     {
-                        status = send(cipher_send, sizeof(cipher_send));
+                        session.active = true;
+                        session.suite = suite;
+                        session.latest_msg = timestamp_us;
+                        session.request_ts = timestamp_us;
+                        session.tx_counter = 0;
+                        replay_window_reset(&session.replay);
+                        memcpy(session.id, session_id, SESSION_ID_SIZE);
+                        status = true;
                     }
                 }
             }
         }
     }
+
+    memset(secret, 0, sizeof(secret));
+    memset(key, 0, sizeof(key));
+
     return status;
 }
 
-static bool handle_handshake_2(uint8_t *key, uint8_t *session_id)
+/*
+ * Handshake 1: | IV | KEY | RAND | COUNT (1) | SUITES (COUNT) | TAG |
+ * encrypted with the pre-shared key, SUITES listing the suites the client
+ * supports. The device answers | SUITE (1) | IV | SESSION_ID | TAG |
+ * encrypted with KEY under the suite it chose, authenticating RAND and SUITE.
+ */
+static bool handle_handshake_1(frame_t *frame, uint8_t *key, uint8_t *session_id, session_suite_t *suite)
 {
     bool status = false;
-    uint8_t plaintext[TIME_STAMP_SIZE];
-    uint8_t cipher[TIME_STAMP_SIZE + TAG_SIZE];
+    uint8_t aad[RAND_SIZE + SUITE_SIZE];
 
-    if (read_timeout(cipher, sizeof(cipher), UART_WAIT_TICKS))
+    if ((frame->type == FRAME_HANDSHAKE) &&
+        (frame->length > IV_SIZE + HANDSHAKE_1_HEADER_SIZE + TAG_SIZE) &&
+        (frame->length <= IV_SIZE + HANDSHAKE_1_HEADER_SIZE + SESSION_SUITE_COUNT + TAG_SIZE))
     {
-        if (decrypt(cipher, plaintext, sizeof(cipher), session_id, SESSION_ID_SIZE))
+        uint8_t *plaintext = frame->payload + IV_SIZE;
+        size_t cipher_len = frame->length - IV_SIZE;
+        memcpy(iv, frame->payload, IV_SIZE);
+
+        if (session_crypto_decrypt(&psk_aead, iv, session_id, SESSION_ID_SIZE, plaintext, cipher_len, plaintext) &&
+            (plaintext[AES_KEY_SIZE + RAND_SIZE] == cipher_len - TAG_SIZE - HANDSHAKE_1_HEADER_SIZE))
         {
-            uint64_t timestamp_us = 0;
-            for (int i = 0; i < BYTE_SIZE; i++)
+            memcpy(key, plaintext, AES_KEY_SIZE);
+            memcpy(aad, plaintext + AES_KEY_SIZE, RAND_SIZE);
+            *suite = session_crypto_choose(plaintext + HANDSHAKE_1_HEADER_SIZE,
+                                           plaintext[AES_KEY_SIZE + RAND_SIZE]);
+            aad[RAND_SIZE] = *suite;
+
+            // Fails without a suite in common, the client then gets no reply
+            if (session_crypto_set_key(&session_aead, *suite, key))
             {
-                timestamp_us = (timestamp_us << BYTE_SIZE) | plaintext[i];
+                if (psa_generate_random(session_id, SESSION_ID_SIZE) == PSA_SUCCESS)
+                {
+                    uint8_t *reply = framing_tx_payload();
+
+                    reply[0] = *suite;
+                    memcpy(reply + SUITE_SIZE + IV_SIZE, session_id, SESSION_ID_SIZE);
+                    status = send_handshake(FRAME_HANDSHAKE, SUITE_SIZE, SESSION_ID_SIZE, aad, sizeof(aad));
+                }
             }
+        }
+
+        // The session key was decrypted in place
+        memset(frame->payload, 0, frame->length);
+    }
+
+    return status;
+}
+
+static bool handle_handshake_2(uint8_t *key, uint8_t *session_id, session_suite_t suite)
+{
+    bool status = false;
+    frame_t *frame;
+
+    if (framing_read(&frame, HANDSHAKE_WAIT_MS) && (frame->type == FRAME_HANDSHAKE) &&
+        (frame->length == IV_SIZE + TIME_STAMP_SIZE + TAG_SIZE))
+    {
+        uint8_t *timestamp = frame->payload + IV_SIZE;
+        memcpy(iv, frame->payload, IV_SIZE);
+
+        if (decrypt(timestamp, timestamp, TIME_STAMP_SIZE + TAG_SIZE, session_id, SESSION_ID_SIZE))
+        {
+            uint64_t timestamp_us = read_be64(timestamp);
             set_rtc_from_timestamp(timestamp_us);
-            if (encrypt(plaintext, cipher, sizeof(plaintext), session_id, SESSION_ID_SIZE))
+
+            // The timestamp is echoed back to prove the device holds the session key
+            memcpy(framing_tx_payload() + IV_SIZE, timestamp, TIME_STAMP_SIZE);
+            if (derive_iv_bases(key) &&
+                send_handshake(FRAME_HANDSHAKE, 0, TIME_STAMP_SIZE, session_id, SESSION_ID_SIZE))
             {
-                if (send(cipher, sizeof(cipher)))
-                {
-                    session.active = true;
-                    session.latest_msg = timestamp_us;
-                    memcpy(session.id, session_id, SESSION_ID_SIZE);
-                    status = true;
-                }
+                session.active = true;
+                session.suite = suite;
+                session.latest_msg = timestamp_us;
+                session.request_ts = timestamp_us;
+                session.tx_counter = 0;
+                replay_window_reset(&session.replay);
+                memcpy(session.id, session_id, SESSION_ID_SIZE);
+                status = true;
             }
         }
     }
@@ -259,50 +479,405 @@ static bool handle_handshake_2(uint8_t *key, uint8_t *session_id)
 bool session_send_temperature(bool temp_status, float temp)
 {
     bool status = false;
-    float_bytes_t fb;
-    fb.f = temp;
-
-    uint8_t cipher[sizeof(bool) + TIME_STAMP_SIZE + sizeof(float) + TAG_SIZE];
-    uint8_t plaintext[sizeof(bool) + TIME_STAMP_SIZE + sizeof(float)];
 
-    uint8_t timestamp_b[TIME_STAMP_SIZE];
-    write_be64(timestamp_b, session.latest_msg);
+    xSemaphoreTakeRecursive(session_lock, portMAX_DELAY);
 
+    uint8_t *plaintext = data_plaintext();
     size_t offset = 0;
     plaintext[offset] = (int8_t)(temp_status ? SESSION_OK : SESSION_ERROR);
-    offset += sizeof(temp_status);
-    memcpy(plaintext + offset, timestamp_b, TIME_STAMP_SIZE);
+    offset += STATUS_SIZE;
+    write_be64(plaintext + offset, session.request_ts);
     offset += TIME_STAMP_SIZE;
-    memcpy(plaintext + offset, &fb.f, sizeof(float));
+    memcpy(plaintext + offset, &temp, sizeof(float));
+    offset += sizeof(float);
+
+    status = send_data(offset);
+
+    xSemaphoreGiveRecursive(session_lock);
 
-    if (encrypt(plaintext, cipher, sizeof(plaintext), session.id, SESSION_ID_SIZE))
+    return status;
+}
+
+bool session_send_toggle_led(bool status, int state)
+{
+    xSemaphoreTakeRecursive(session_lock, portMAX_DELAY);
+
+    uint8_t *plaintext = data_plaintext();
+    plaintext[0] = (int8_t)(status ? SESSION_OK : SESSION_ERROR);
+    write_be64(plaintext + STATUS_SIZE, session.request_ts);
+    plaintext[STATUS_SIZE + TIME_STAMP_SIZE] = state;
+
+    status = send_data(STATUS_SIZE + TIME_STAMP_SIZE + sizeof(bool));
+
+    xSemaphoreGiveRecursive(session_lock);
+
+    return status;
+}
+
+size_t session_get_batch(session_request_t *commands, size_t max_commands)
+{
+    size_t count = 0;
+
+    if (session.args_len >= COUNT_SIZE)
     {
-        status = send(cipher, sizeof(cipher));
+        count = session.args[0];
+        if (count > max_commands)
+        {
+            count = max_commands;
+        }
+
+        for (size_t i = 0; i < count; i++)
+        {
+            commands[i] = (session_request_t)session.args[COUNT_SIZE + i];
+        }
     }
 
+    return count;
+}
+
+bool session_send_batch(const session_batch_result_t *results, size_t count)
+{
+    bool status = false;
+    bool batch_ok = true;
+
+    if (count > SESSION_BATCH_MAX_COMMANDS)
+    {
+        count = SESSION_BATCH_MAX_COMMANDS;
+    }
+
+    xSemaphoreTakeRecursive(session_lock, portMAX_DELAY);
+
+    uint8_t *plaintext = data_plaintext();
+    size_t offset = STATUS_SIZE;
+    write_be64(plaintext + offset, session.request_ts);
+    offset += TIME_STAMP_SIZE;
+    plaintext[offset] = (uint8_t)count;
+    offset += COUNT_SIZE;
+
+    // Each result: request, status and the value that request returns
+    for (size_t i = 0; i < count; i++)
+    {
+        plaintext[offset++] = (uint8_t)results[i].request;
+        plaintext[offset++] = (int8_t)(results[i].status ? SESSION_OK : SESSION_ERROR);
+
+        if (results[i].request == GET_TEMP)
+        {
+            memcpy(plaintext + offset, &results[i].temperature, sizeof(float));
+            offset += sizeof(float);
+        }
+        else if (results[i].request == TOGGLE_LED)
+        {
+            plaintext[offset++] = results[i].led_state;
+        }
+
+        batch_ok = batch_ok && results[i].status;
+    }
+
+    plaintext[0] = (int8_t)(batch_ok ? SESSION_OK : SESSION_ERROR);
+
+    status = send_data(offset);
+
+    xSemaphoreGiveRecursive(session_lock);
+
     return status;
 }
 
-bool session_send_toggle_led(bool status, int state)
+bool session_get_subscription(uint16_t *interval_ms, uint16_t *threshold_centi)
 {
-    uint8_t cipher[sizeof(bool) + TIME_STAMP_SIZE + sizeof(bool) + TAG_SIZE];
-    uint8_t plaintext[sizeof(bool) + TIME_STAMP_SIZE + sizeof(bool)];
+    bool status = false;
 
-    uint8_t timestamp_b[TIME_STAMP_SIZE];
-    write_be64(timestamp_b, session.latest_msg);
+    if (session.args_len == SUBSCRIPTION_ARGS_SIZE)
+    {
+        *interval_ms = read_be16(session.args);
+        *threshold_centi = read_be16(session.args + sizeof(uint16_t));
+        status = true;
+    }
 
-    plaintext[0] = (int8_t)(status ? SESSION_OK : SESSION_ERROR);
-    memcpy(plaintext + sizeof(bool), timestamp_b, TIME_STAMP_SIZE);
-    plaintext[sizeof(bool) + TIME_STAMP_SIZE] = state;
+    return status;
+}
+
+bool session_get_pixels(uint32_t led_count, session_pixels_fill_t fill)
+{
+    // A frame running off the strip is refused before any run is drawn
+    bool status = pixels_is_valid() && (pixels_end() <= led_count);
+
+    if (status)
+    {
+        uint32_t pixel = read_be16(session.args);
+        size_t palette_size = session.args[sizeof(uint16_t)];
+        const uint8_t *palette = session.args + PIXELS_HEADER_SIZE;
+        size_t offset = PIXELS_HEADER_SIZE + palette_size * PALETTE_ENTRY_SIZE;
+
+        for (; status && (offset < session.args_len); offset += RUN_SIZE)
+        {
+            uint32_t run = session.args[offset];
+            status = fill(pixel, run, palette + session.args[offset + 1] * PALETTE_ENTRY_SIZE);
+            pixel += run;
+        }
+    }
+
+    return status;
+}
+
+bool session_send_status(bool request_status)
+{
+    bool status = false;
+
+    xSemaphoreTakeRecursive(session_lock, portMAX_DELAY);
 
-    if (encrypt(plaintext, cipher, sizeof(plaintext), session.id, SESSION_ID_SIZE))
+    uint8_t *plaintext = data_plaintext();
+    plaintext[0] = (int8_t)(request_status ? SESSION_OK : SESSION_ERROR);
+    write_be64(plaintext + STATUS_SIZE, session.request_ts);
+
+    status = send_data(STATUS_SIZE + TIME_STAMP_SIZE);
+
+    xSemaphoreGiveRecursive(session_lock);
+
+    return status;
+}
+
+bool session_send_samples(uint16_t index, uint16_t count, const uint8_t *blocks, size_t len)
+{
+    bool status = false;
+
+    if (len <= SESSION_SAMPLES_MAX_CHUNK)
     {
-        status = send(cipher, sizeof(cipher));
+        xSemaphoreTakeRecursive(session_lock, portMAX_DELAY);
+
+        uint8_t *plaintext = data_plaintext();
+        size_t offset = 0;
+        plaintext[offset] = (int8_t)SESSION_OK;
+        offset += STATUS_SIZE;
+        write_be64(plaintext + offset, session.request_ts);
+        offset += TIME_STAMP_SIZE;
+        write_be16(plaintext + offset, index);
+        write_be16(plaintext + offset + sizeof(uint16_t), count);
+        offset += CHUNK_HEADER_SIZE;
+        memcpy(plaintext + offset, blocks, len);
+        offset += len;
+
+        status = send_data(offset);
+
+        xSemaphoreGiveRecursive(session_lock);
     }
 
     return status;
 }
 
+bool session_push_temperature(bool temp_status, float temp)
+{
+    bool status = false;
+
+    xSemaphoreTakeRecursive(session_lock, portMAX_DELAY);
+
+    // The frame buffer is only touched while a session is up, never during a handshake
+    if (session.active && session.subscribed)
+    {
+        uint8_t *plaintext = data_plaintext();
+        plaintext[0] = (int8_t)(temp_status ? SESSION_OK : SESSION_ERROR);
+        // Pushes are not answers to a request, so they carry the device time
+        write_be64(plaintext + STATUS_SIZE, now_us());
+        memcpy(plaintext + STATUS_SIZE + TIME_STAMP_SIZE, &temp, sizeof(float));
+
+        status = send_sequenced(FRAME_PUSH, session.push_seq, STATUS_SIZE + TIME_STAMP_SIZE + sizeof(float));
+    }
+
+    xSemaphoreGiveRecursive(session_lock);
+
+    return status;
+}
+
+static bool batch_is_valid(void)
+{
+    bool valid = (session.args_len >= COUNT_SIZE) &&
+                 (session.args[0] > 0) &&
+                 (session.args[0] <= SESSION_BATCH_MAX_COMMANDS) &&
+                 (session.args_len == (size_t)(COUNT_SIZE + session.args[0]));
+
+    for (size_t i = 0; valid && (i < session.args[0]); i++)
+    {
+        uint8_t command = session.args[COUNT_SIZE + i];
+        valid = (command == GET_TEMP) || (command == TOGGLE_LED);
+    }
+
+    return valid;
+}
+
+static bool ticket_key_init(void)
+{
+    // Tickets and handshake 1 are not negotiated, they always use AES-256-GCM
+    return session_crypto_generate_key(&ticket_aead, SESSION_SUITE_AES_256_GCM);
+}
+
+/* The pre-shared key is parsed and expanded once, only its context is kept. */
+static bool psk_init(void)
+{
+    uint8_t psk[AES_KEY_SIZE];
+    bool status = (sizeof(HSECRET) - 1 == 2 * AES_KEY_SIZE) &&
+                  hex_to_bytes(HSECRET, psk, AES_KEY_SIZE) &&
+                  session_crypto_set_key(&psk_aead, SESSION_SUITE_AES_256_GCM, psk);
+
+    memset(psk, 0, sizeof(psk));
+
+    return status;
+}
+
+/*
+ * Writes | RESUMPTION_SECRET | TICKET | where the ticket is
+ * | IV | GENERATION (4) | ISSUED_AT (8) | SUITE (1) | RESUMPTION_SECRET | TAG |
+ * encrypted with the ticket key.
+ */
+static bool issue_ticket(uint8_t *resumption)
+{
+    uint8_t *ticket = resumption + RESUMPTION_SECRET_SIZE;
+    uint8_t *plaintext = ticket + IV_SIZE;
+
+    ticket_generation++;
+    ticket_live = false;
+
+    if ((psa_generate_random(resumption, RESUMPTION_SECRET_SIZE) == PSA_SUCCESS) &&
+        (psa_generate_random(ticket, IV_SIZE) == PSA_SUCCESS))
+    {
+        write_be32(plaintext, ticket_generation);
+        write_be64(plaintext + GENERATION_SIZE, now_us());
+        plaintext[GENERATION_SIZE + TIME_STAMP_SIZE] = session.suite;
+        memcpy(plaintext + GENERATION_SIZE + TIME_STAMP_SIZE + SUITE_SIZE, resumption, RESUMPTION_SECRET_SIZE);
+
+        ticket_live = session_crypto_encrypt(&ticket_aead, ticket, NULL, 0,
+                                             plaintext, TICKET_PLAINTEXT_SIZE, plaintext);
+    }
+
+    if (!ticket_live)
+    {
+        memset(resumption, 0, RESUMPTION_SIZE);
+    }
+
+    return ticket_live;
+}
+
+/* Leaves the ticket live, it is spent once the client proves it holds the secret. */
+static bool open_ticket(uint8_t *ticket, uint8_t *secret, session_suite_t *suite)
+{
+    bool status = false;
+    uint8_t *plaintext = ticket + IV_SIZE;
+
+    if (ticket_live &&
+        session_crypto_decrypt(&ticket_aead, ticket, NULL, 0,
+                               plaintext, TICKET_PLAINTEXT_SIZE + TAG_SIZE, plaintext))
+    {
+        uint64_t issued_at = read_be64(plaintext + GENERATION_SIZE);
+        uint64_t now = now_us();
+
+        if ((read_be32(plaintext) == ticket_generation) &&
+            (now >= issued_at) && ((now - issued_at) <= TICKET_LIFETIME_US))
+        {
+            *suite = (session_suite_t)plaintext[GENERATION_SIZE + TIME_STAMP_SIZE];
+            memcpy(secret, plaintext + GENERATION_SIZE + TIME_STAMP_SIZE + SUITE_SIZE, RESUMPTION_SECRET_SIZE);
+            status = true;
+        }
+    }
+
+    // Decrypted in place in the received frame
+    memset(plaintext, 0, TICKET_PLAINTEXT_SIZE);
+
+    return status;
+}
+
+/* mac must hold HMAC_SIZE bytes. */
+static bool hmac_sha256(const uint8_t *key, size_t key_len, const uint8_t *msg, size_t msg_len, uint8_t *mac)
+{
+    bool status = false;
+    psa_key_handle_t mac_key = 0;
+    size_t out_len;
+
+    psa_key_attributes_t attr = PSA_KEY_ATTRIBUTES_INIT;
+
+    psa_set_key_type(&attr, PSA_KEY_TYPE_HMAC);
+    psa_set_key_bits(&attr, key_len * 8);
+    psa_set_key_usage_flags(&attr, PSA_KEY_USAGE_SIGN_MESSAGE);
+    psa_set_key_algorithm(&attr, PSA_ALG_HMAC(PSA_ALG_SHA_256));
+
+    if (PSA_SUCCESS == psa_import_key(&attr, key, key_len, &mac_key))
+    {
+        status = (PSA_SUCCESS == psa_mac_compute(mac_key,
+                                                 PSA_ALG_HMAC(PSA_ALG_SHA_256),
+                                                 msg,
+                                                 msg_len,
+                                                 mac,
+                                                 HMAC_SIZE,
+                                                 &out_len));
+        psa_destroy_key(mac_key);
+    }
+
+    return status;
+}
+
+/*
+ * Data frames do not carry an IV. Each direction has its own IV base,
+ * derived from the session key, and the nonce is that base XOR a counter.
+ */
+static bool derive_iv_bases(const uint8_t *key)
+{
+    static const uint8_t label_c2d[] = {'c', '2', 'd', ' ', 'i', 'v'};
+    static const uint8_t label_d2c[] = {'d', '2', 'c', ' ', 'i', 'v'};
+    uint8_t mac[HMAC_SIZE];
+    bool status = false;
+
+    if (hmac_sha256(key, AES_KEY_SIZE, label_c2d, sizeof(label_c2d), mac))
+    {
+        memcpy(session.iv_c2d, mac, IV_SIZE);
+
+        if (hmac_sha256(key, AES_KEY_SIZE, label_d2c, sizeof(label_d2c), mac))
+        {
+            memcpy(session.iv_d2c, mac, IV_SIZE);
+            status = true;
+        }
+    }
+
+    memset(mac, 0, sizeof(mac));
+
+    return status;
+}
+
+static bool subscription_is_valid(void)
+{
+    return (session.args_len == SUBSCRIPTION_ARGS_SIZE) &&
+           (read_be16(session.args) > 0);
+}
+
+static bool pixels_is_valid(void)
+{
+    bool valid = (session.args_len >= PIXELS_HEADER_SIZE) &&
+                 (session.args[sizeof(uint16_t)] > 0);
+    size_t palette_size = valid ? session.args[sizeof(uint16_t)] : 0;
+    size_t offset = PIXELS_HEADER_SIZE + palette_size * PALETTE_ENTRY_SIZE;
+
+    valid = valid && (session.args_len >= offset) &&
+            (((session.args_len - offset) % RUN_SIZE) == 0);
+
+    for (; valid && (offset < session.args_len); offset += RUN_SIZE)
+    {
+        valid = (session.args[offset] > 0) &&
+                (session.args[offset + 1] < palette_size);
+    }
+
+    return valid;
+}
+
+/* One past the last pixel of a valid SET_PIXELS frame. */
+static uint32_t pixels_end(void)
+{
+    uint32_t end = read_be16(session.args);
+    size_t offset = PIXELS_HEADER_SIZE + session.args[sizeof(uint16_t)] * PALETTE_ENTRY_SIZE;
+
+    for (; offset < session.args_len; offset += RUN_SIZE)
+    {
+        end += session.args[offset];
+    }
+
+    return end;
+}
+
 static void set_rtc_from_timestamp(uint64_t timestamp_us)
 {
     struct timeval tv;
@@ -313,12 +888,46 @@ static void set_rtc_from_timestamp(uint64_t timestamp_us)
     settimeofday(&tv, NULL);
 }
 
-static void hex_to_bytes(const char *hex, uint8_t *out, size_t len)
+static int hex_digit(char c)
 {
-    for (size_t i = 0; i < len; i++)
+    int value = -1;
+
+    if ((c >= '0') && (c <= '9'))
     {
-        sscanf(hex + 2 * i, "%2hhx", &out[i]);
+        value = c - '0';
     }
+    else if ((c >= 'a') && (c <= 'f'))
+    {
+        value = c - 'a' + 10;
+    }
+    else if ((c >= 'A') && (c <= 'F'))
+    {
+        value = c - 'A' + 10;
+    }
+
+    return value;
+}
+
+static bool hex_to_bytes(const char *hex, uint8_t *out, size_t len)
+{
+    bool status = true;
+
+    for (size_t i = 0; status && (i < len); i++)
+    {
+        int high = hex_digit(hex[2 * i]);
+        int low = hex_digit(hex[2 * i + 1]);
+
+        if ((high >= 0) && (low >= 0))
+        {
+            out[i] = (uint8_t)((high << 4) | low);
+        }
+        else
+        {
+            status = false;
+        }
+    }
+
+    return status;
 }
 
 static inline void write_be64(uint8_t *buf, uint64_t v)
@@ -333,112 +942,162 @@ static inline void write_be64(uint8_t *buf, uint64_t v)
     buf[7] = v & 0xFF;
 }
 
-static bool encrypt(uint8_t *plaintext, uint8_t *cipher, size_t msg_len, uint8_t *AAD, size_t AAD_len)
+static inline void write_be32(uint8_t *buf, uint32_t v)
 {
-    bool status = false;
-    size_t out_len;
+    buf[0] = (v >> 24) & 0xFF;
+    buf[1] = (v >> 16) & 0xFF;
+    buf[2] = (v >> 8) & 0xFF;
+    buf[3] = v & 0xFF;
+}
 
-    if (psa_generate_random(iv, IV_SIZE) == PSA_SUCCESS)
-    {
-        psa_status_t psa_status = psa_aead_encrypt(
-            gcm_key,
-            PSA_ALG_GCM,
-            iv,
-            IV_SIZE,
-            AAD,
-            AAD_len,
-            plaintext,
-            msg_len,
-            cipher,
-            msg_len + TAG_SIZE,
-            &out_len);
-
-        if (psa_status == PSA_SUCCESS)
-        {
-            status = true;
-        }
-    }
+static inline uint32_t read_be32(const uint8_t *buf)
+{
+    return ((uint32_t)buf[0] << 24) | ((uint32_t)buf[1] << 16) |
+           ((uint32_t)buf[2] << 8) | (uint32_t)buf[3];
+}
 
-    return status;
+static inline void write_be16(uint8_t *buf, uint16_t v)
+{
+    buf[0] = (v >> 8) & 0xFF;
+    buf[1] = v & 0xFF;
 }
 
-static bool decrypt(uint8_t *cipher, uint8_t *plaintext, size_t cipher_len, uint8_t *AAD, size_t AAD_len)
+static inline uint64_t read_be64(const uint8_t *buf)
 {
-    size_t out_len;
-    size_t plaintext_len = cipher_len - TAG_SIZE;
+    return ((uint64_t)read_be32(buf) << 32) | (uint64_t)read_be32(buf + 4);
+}
 
-    psa_status_t status = psa_aead_decrypt(
-        gcm_key,
-        PSA_ALG_GCM,
-        iv,
-        IV_SIZE,
-        AAD,
-        AAD_len,
-        cipher,
-        cipher_len,
-        plaintext,
-        plaintext_len,
-        &out_len);
+static inline uint16_t read_be16(const uint8_t *buf)
+{
+    return (uint16_t)(((uint16_t)buf[0] << 8) | (uint16_t)buf[1]);
+}
+
+static uint64_t now_us(void)
+{
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
 
-    return status == PSA_SUCCESS;
+    return (uint64_t)tv.tv_sec * 1000000ULL + (uint64_t)tv.tv_usec;
 }
 
-static bool send(uint8_t *cipher, size_t len)
+/* Data frames authenticate the session ID and the sequence number in their header. */
+static void data_aad(uint8_t *aad, uint32_t seq)
 {
-    memcpy(tx_buf, iv, IV_SIZE);
-    memcpy(tx_buf + IV_SIZE, cipher, len);
+    memcpy(aad, session.id, SESSION_ID_SIZE);
+    write_be32(aad + SESSION_ID_SIZE, seq);
+}
 
-    return (communication_write(tx_buf, IV_SIZE + len));
+/* Client to device frames count with their sequence number, device to client ones with tx_counter. */
+static void data_iv(const uint8_t *base, uint32_t counter)
+{
+    memcpy(iv, base, IV_SIZE);
+    iv[IV_SIZE - 4] ^= (counter >> 24) & 0xFF;
+    iv[IV_SIZE - 3] ^= (counter >> 16) & 0xFF;
+    iv[IV_SIZE - 2] ^= (counter >> 8) & 0xFF;
+    iv[IV_SIZE - 1] ^= counter & 0xFF;
 }
 
-static bool read(uint8_t *cipher, size_t len_cipher)
+/* Handshake frames still carry a random IV, the session key is not known yet. */
+static bool random_iv(void)
 {
-    bool status = false;
+    return (psa_generate_random(iv, IV_SIZE) == PSA_SUCCESS);
+}
+
+static bool encrypt(uint8_t *plaintext, uint8_t *cipher, size_t msg_len, const uint8_t *AAD, size_t AAD_len)
+{
+    return session_crypto_encrypt(&session_aead, iv, AAD, AAD_len, plaintext, msg_len, cipher);
+}
 
-    int len = communication_read(rx_buf, IV_SIZE + len_cipher);
+static bool decrypt(uint8_t *cipher, uint8_t *plaintext, size_t cipher_len, const uint8_t *AAD, size_t AAD_len)
+{
+    return session_crypto_decrypt(&session_aead, iv, AAD, AAD_len, cipher, cipher_len, plaintext);
+}
 
-    if (len == (IV_SIZE + len_cipher))
-    {
-        memcpy(iv, rx_buf, IV_SIZE);
-        memcpy(cipher, rx_buf + IV_SIZE, len_cipher);
+/*
+ * Handshake frames are | IV | CIPHER | TAG |, behind offset bytes sent in
+ * clear. The caller builds the msg_len bytes of plaintext at
+ * framing_tx_payload() + offset + IV_SIZE, where they are encrypted in
+ * place under a fresh random IV.
+ */
+static bool send_handshake(uint8_t type, size_t offset, size_t msg_len, const uint8_t *AAD, size_t AAD_len)
+{
+    bool status = false;
+    uint8_t *payload = framing_tx_payload() + offset;
 
-        status = true;
+    if (random_iv())
+    {
+        memcpy(payload, iv, IV_SIZE);
+        status = encrypt(payload + IV_SIZE, payload + IV_SIZE, msg_len, AAD, AAD_len) &&
+                 framing_send(type, offset + IV_SIZE + msg_len + TAG_SIZE);
     }
 
     return status;
 }
 
-static bool read_timeout(uint8_t *cipher, size_t len_cipher, size_t wait_ml)
+/* Where a data message is built, behind the clear header of its frame. */
+static uint8_t *data_plaintext(void)
 {
-    bool status = false;
+    return framing_tx_payload() + DATA_HEADER_SIZE;
+}
 
-    int len = communication_read_timeout(rx_buf, IV_SIZE + len_cipher, wait_ml);
+/*
+ * Data frames from the device carry the counter of their nonce and the
+ * sequence number of the request in clear, so responses can be matched to
+ * requests while several are in flight. Frames from the client only carry
+ * the sequence number, which is also their nonce counter.
+ */
+static bool send_data(size_t msg_len)
+{
+    return send_sequenced(FRAME_DATA, session.request_seq, msg_len);
+}
 
-    if (len == IV_SIZE + len_cipher)
-    {
-        memcpy(iv, rx_buf, IV_SIZE);
-        memcpy(cipher, rx_buf + IV_SIZE, len_cipher);
+/*
+ * Push frames use the same layout, with the sequence number of the
+ * subscription. The msg_len bytes built at data_plaintext() are encrypted
+ * in place and sent from the same buffer. Callers hold session_lock from
+ * building the message until it is sent.
+ */
+static bool send_sequenced(uint8_t type, uint32_t seq, size_t msg_len)
+{
+    bool status = false;
+    uint8_t aad[DATA_AAD_SIZE];
+    uint8_t *payload = framing_tx_payload();
 
-        status = true;
+    // A wrapped counter would repeat a nonce
+    if (session.tx_counter < UINT32_MAX)
+    {
+        session.tx_counter++;
+        data_iv(session.iv_d2c, session.tx_counter);
+        data_aad(aad, seq);
+        write_be32(payload, session.tx_counter);
+        write_be32(payload + COUNTER_SIZE, seq);
+
+        status = encrypt(payload + DATA_HEADER_SIZE, payload + DATA_HEADER_SIZE, msg_len, aad, sizeof(aad)) &&
+                 framing_send(type, DATA_HEADER_SIZE + msg_len + TAG_SIZE);
     }
+
     return status;
 }
 
-static bool gcm_init_psa(const uint8_t *key)
+/* On success cipher points into the received frame, valid until the next framing_read. */
+static bool read_data(uint32_t *seq, uint8_t **cipher, size_t *len_cipher)
 {
-    if (gcm_key != 0)
-    {
-        psa_destroy_key(gcm_key);
-        gcm_key = 0;
-    }
+    bool status = false;
+    frame_t *frame;
 
-    psa_key_attributes_t attr = PSA_KEY_ATTRIBUTES_INIT;
+    if (framing_read(&frame, FRAMING_WAIT_FOREVER))
+    {
+        if ((frame->type == FRAME_DATA) &&
+            (frame->length > (SEQ_SIZE + TAG_SIZE)) &&
+            (frame->length <= (SEQ_SIZE + MAX_PAYLOAD_SIZE_RX + TAG_SIZE)))
+        {
+            *len_cipher = frame->length - SEQ_SIZE;
+            *seq = read_be32(frame->payload);
+            *cipher = frame->payload + SEQ_SIZE;
 
-    psa_set_key_type(&attr, PSA_KEY_TYPE_AES);
-    psa_set_key_bits(&attr, AES_KEY_SIZE * 8);
-    psa_set_key_usage_flags(&attr,
-                            PSA_KEY_USAGE_ENCRYPT | PSA_KEY_USAGE_DECRYPT);
-    psa_set_key_algorithm(&attr, PSA_ALG_GCM);
+            status = true;
+        }
+    }
 
-    return (PSA_SUCCESS == psa_import_key(&attr, key, AES_KEY_SIZE, &gcm_key));
-}
\ No newline at end of file
+    return status;
+}
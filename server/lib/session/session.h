@@ -1,27 +1,59 @@
 #ifndef SESSION_H
 #define SESSION_H
 
+#include <stddef.h>
 #include <stdint.h>
 #include <stdbool.h>
+#include "transport.h"
+
+#define SESSION_BATCH_MAX_COMMANDS 16
+#define SESSION_SAMPLES_MAX_CHUNK 960
+#define SESSION_PIXELS_MAX_SIZE 960
 
 typedef enum
 {
     INVALID = -1,
     CLOSE_SESSION = 0,
     GET_TEMP = 1,
-    TOGGLE_LED = 2
+    TOGGLE_LED = 2,
+    BATCH = 4,
+    SUBSCRIBE_TEMP = 5,
+    UNSUBSCRIBE_TEMP = 6,
+    DUMP_SAMPLES = 7,
+    SET_PIXELS = 8
 } session_request_t;
 
+typedef struct
+{
+    session_request_t request; // GET_TEMP or TOGGLE_LED
+    bool status;               // true if the command succeeded
+    float temperature;         // result of GET_TEMP
+    int led_state;             // result of TOGGLE_LED
+} session_batch_result_t;
+
+/*
+ * SET_PIXELS carries a palette-indexed, run-length encoded frame:
+ *
+ *   | START (2, BE) | N (1) | PALETTE R, G, B (3 * N) | { RUN (1) | INDEX (1) }* |
+ *
+ * Each run sets RUN consecutive pixels, from 1 to 255, to palette entry
+ * INDEX. The runs follow each other from pixel START onwards.
+ */
+typedef bool (*session_pixels_fill_t)(uint32_t start, uint32_t count, const uint8_t *rgb);
+
 /**
  * @brief Initialize the session subsystem and crypto context.
  *
- * Initializes communication and PSA crypto. Must be called once
- * before any other session function.
+ * Opens the link to the client and initializes PSA crypto. Must be
+ * called once before any other session function.
+ *
+ * @param transport Link to the client, e.g. &transport_uart
+ * @param params    Parameters of the link, e.g. the baud rate
  *
  * @return true  If initialization succeeded
  * @return false If initialization failed
  */
-bool session_init(void);
+bool session_init(transport_t *transport, const char *params);
 
 /**
  * @brief Check whether a secure session is currently active.
@@ -38,6 +70,11 @@ bool session_is_active(void);
  * negotiates a session key and session ID, synchronizes time, and
  * enables encrypted communication.
  *
+ * A client holding the ticket from the last session_close() may instead
+ * resume in a single round trip. The new session key is derived from
+ * the secret sealed in the ticket. A ticket is valid once, for an hour,
+ * and only until the next ticket is issued.
+ *
  * This function blocks until the handshake completes or fails.
  *
  * @return true  If the session was successfully established
@@ -51,8 +88,16 @@ bool session_establish(void);
  * Waits for an encrypted request packet, authenticates and decrypts it,
  * validates timestamp freshness, and updates session state.
  *
+ * Replays are rejected with a sliding window over the request sequence
+ * numbers, so requests may arrive out of order by up to
+ * REPLAY_WINDOW_SIZE. Each response echoes the timestamp of its request.
+ *
  * If the session expired or the request is invalid, INVALID is returned.
  *
+ * Requests may be pipelined by the client. The sequence number of the
+ * accepted request is echoed by the following session_send_* response,
+ * and requests already received are served without waiting on the link.
+ *
  * @return session_request_t The decoded request type or INVALID
  */
 session_request_t session_get_request(void);
@@ -85,12 +130,117 @@ bool session_send_temperature(bool status, float temp);
  */
 bool session_send_toggle_led(bool status, int state);
 
+/**
+ * @brief Get the commands carried by the last BATCH request.
+ *
+ * Only valid after session_get_request() returned BATCH. The commands
+ * are GET_TEMP or TOGGLE_LED, in the order the client sent them.
+ *
+ * @param commands     Destination array
+ * @param max_commands Capacity of the destination array
+ *
+ * @return size_t Number of commands written to the array
+ */
+size_t session_get_batch(session_request_t *commands, size_t max_commands);
+
+/**
+ * @brief Send the encrypted results of a BATCH request to the client.
+ *
+ * All results go out in a single encrypted response containing the
+ * overall status, timestamp, result count, and for each command its
+ * request type, status and value.
+ *
+ * @param results Array of results, in the order of the commands
+ * @param count   Number of results, at most SESSION_BATCH_MAX_COMMANDS
+ *
+ * @return true  If the encrypted response was sent successfully
+ * @return false If encryption or transmission failed
+ */
+bool session_send_batch(const session_batch_result_t *results, size_t count);
+
+/**
+ * @brief Get the parameters of the last SUBSCRIBE_TEMP request.
+ *
+ * Only valid after session_get_request() returned SUBSCRIBE_TEMP.
+ *
+ * @param interval_ms     Sample interval in milliseconds, never 0
+ * @param threshold_centi Minimum change in hundredths of a degree before
+ *                        a sample is pushed, 0 to push every sample
+ *
+ * @return true  If the request carried subscription parameters
+ * @return false Otherwise
+ */
+bool session_get_subscription(uint16_t *interval_ms, uint16_t *threshold_centi);
+
+/**
+ * @brief Decode the frame carried by a SET_PIXELS request.
+ *
+ * The frame is read in place from the decrypted request and handed over
+ * run by run, so it can be written straight into the strip. A frame that
+ * does not fit the strip is refused before fill is called.
+ *
+ * @param led_count Number of LEDs of the strip
+ * @param fill      Called once per run with its first pixel, its length and
+ *                  the palette colour, returns false to stop decoding
+ *
+ * @return true  If the frame fits the strip and every run was accepted by fill
+ * @return false Otherwise
+ */
+bool session_get_pixels(uint32_t led_count, session_pixels_fill_t fill);
+
+/**
+ * @brief Send an encrypted response carrying only a status.
+ *
+ * Used to acknowledge SUBSCRIBE_TEMP, UNSUBSCRIBE_TEMP and SET_PIXELS.
+ *
+ * @param status true if the request was carried out
+ *
+ * @return true  If the encrypted response was sent successfully
+ * @return false If encryption or transmission failed
+ */
+bool session_send_status(bool status);
+
+/**
+ * @brief Send one encrypted chunk of a DUMP_SAMPLES response.
+ *
+ * A dump is answered with count responses, all carrying the sequence
+ * number of the DUMP_SAMPLES request. Each holds the status, timestamp,
+ * chunk index and chunk count, followed by the sample blocks.
+ *
+ * @param index  Index of this chunk, from 0
+ * @param count  Number of chunks in the dump
+ * @param blocks Encoded sample blocks
+ * @param len    Length of blocks, at most SESSION_SAMPLES_MAX_CHUNK
+ *
+ * @return true  If the encrypted chunk was sent successfully
+ * @return false If the chunk is too large, or encryption or
+ *               transmission failed
+ */
+bool session_send_samples(uint16_t index, uint16_t count, const uint8_t *blocks, size_t len);
+
+/**
+ * @brief Push an encrypted temperature sample to a subscribed client.
+ *
+ * Safe to call from another task than the one serving requests. The
+ * sample is sent in a push frame tagged with the sequence number of the
+ * SUBSCRIBE_TEMP request and carries the device time.
+ *
+ * @param status true if the temperature reading is valid, false on error
+ * @param temp   Temperature value in degrees (float)
+ *
+ * @return true  If the sample was sent
+ * @return false If there is no subscription, or encryption or
+ *               transmission failed
+ */
+bool session_push_temperature(bool status, float temp);
+
 /**
  * @brief Close the active session and notify the client.
  *
  * Sends an encrypted close response containing the final session
  * status and timestamp, then clears session state and destroys
- * the AES key.
+ * the AES key. The response also carries a resumption secret and a
+ * ticket sealing it, for session_establish() to resume with.
  *
  * @return true  If the close message was sent successfully
  * @return false If encryption or transmission failed
@@ -0,0 +1,235 @@
+#include <string.h>
+#include <psa/crypto.h>
+#include "session_crypto.h"
+
+#define AES_128_KEY_SIZE 16
+
+struct session_crypto_suite
+{
+    session_suite_t id;
+    const char *name;
+    size_t key_size;
+    bool (*set_key)(session_crypto_ctx_t *ctx, const uint8_t *key, size_t key_size);
+    bool (*encrypt)(session_crypto_ctx_t *ctx, const uint8_t *iv, const uint8_t *aad, size_t aad_len,
+                    const uint8_t *input, size_t len, uint8_t *output, uint8_t *tag);
+    bool (*decrypt)(session_crypto_ctx_t *ctx, const uint8_t *iv, const uint8_t *aad, size_t aad_len,
+                    const uint8_t *input, size_t len, uint8_t *output, const uint8_t *tag);
+    void (*free)(session_crypto_ctx_t *ctx);
+};
+
+static const session_crypto_suite_t *find_suite(session_suite_t id);
+static bool gcm_set_key(session_crypto_ctx_t *ctx, const uint8_t *key, size_t key_size);
+static bool gcm_encrypt(session_crypto_ctx_t *ctx, const uint8_t *iv, const uint8_t *aad, size_t aad_len,
+                        const uint8_t *input, size_t len, uint8_t *output, uint8_t *tag);
+static bool gcm_decrypt(session_crypto_ctx_t *ctx, const uint8_t *iv, const uint8_t *aad, size_t aad_len,
+                        const uint8_t *input, size_t len, uint8_t *output, const uint8_t *tag);
+static void gcm_free(session_crypto_ctx_t *ctx);
+static bool ccm_set_key(session_crypto_ctx_t *ctx, const uint8_t *key, size_t key_size);
+static bool ccm_encrypt(session_crypto_ctx_t *ctx, const uint8_t *iv, const uint8_t *aad, size_t aad_len,
+                        const uint8_t *input, size_t len, uint8_t *output, uint8_t *tag);
+static bool ccm_decrypt(session_crypto_ctx_t *ctx, const uint8_t *iv, const uint8_t *aad, size_t aad_len,
+                        const uint8_t *input, size_t len, uint8_t *output, const uint8_t *tag);
+static void ccm_free(session_crypto_ctx_t *ctx);
+#if defined(MBEDTLS_CHACHAPOLY_C)
+static bool chachapoly_set_key(session_crypto_ctx_t *ctx, const uint8_t *key, size_t key_size);
+static bool chachapoly_encrypt(session_crypto_ctx_t *ctx, const uint8_t *iv, const uint8_t *aad, size_t aad_len,
+                               const uint8_t *input, size_t len, uint8_t *output, uint8_t *tag);
+static bool chachapoly_decrypt(session_crypto_ctx_t *ctx, const uint8_t *iv, const uint8_t *aad, size_t aad_len,
+                               const uint8_t *input, size_t len, uint8_t *output, const uint8_t *tag);
+static void chachapoly_free(session_crypto_ctx_t *ctx);
+#endif
+
+static const session_crypto_suite_t suites[] = {
+    {SESSION_SUITE_AES_128_GCM, "AES-128-GCM", AES_128_KEY_SIZE, gcm_set_key, gcm_encrypt, gcm_decrypt, gcm_free},
+    {SESSION_SUITE_AES_256_GCM, "AES-256-GCM", SESSION_CRYPTO_KEY_SIZE, gcm_set_key, gcm_encrypt, gcm_decrypt, gcm_free},
+#if defined(MBEDTLS_CHACHAPOLY_C)
+    {SESSION_SUITE_CHACHA20_POLY1305, "ChaCha20-Poly1305", SESSION_CRYPTO_KEY_SIZE,
+     chachapoly_set_key, chachapoly_encrypt, chachapoly_decrypt, chachapoly_free},
+#endif
+    {SESSION_SUITE_AES_128_CCM, "AES-128-CCM", AES_128_KEY_SIZE, ccm_set_key, ccm_encrypt, ccm_decrypt, ccm_free},
+};
+
+static const session_suite_t preference[] = {SESSION_CRYPTO_PREFERENCE};
+
+static const session_crypto_suite_t *find_suite(session_suite_t id)
+{
+    const session_crypto_suite_t *suite = NULL;
+
+    for (size_t i = 0; (suite == NULL) && (i < sizeof(suites) / sizeof(suites[0])); i++)
+    {
+        suite = (suites[i].id == id) ? &suites[i] : NULL;
+    }
+
+    return suite;
+}
+
+const char *session_crypto_suite_name(session_suite_t suite)
+{
+    const session_crypto_suite_t *found = find_suite(suite);
+
+    return (found != NULL) ? found->name : NULL;
+}
+
+session_suite_t session_crypto_choose(const uint8_t *offered, size_t count)
+{
+    session_suite_t chosen = SESSION_SUITE_NONE;
+
+    for (size_t i = 0; (chosen == SESSION_SUITE_NONE) && (i < sizeof(preference) / sizeof(preference[0])); i++)
+    {
+        for (size_t j = 0; j < count; j++)
+        {
+            if ((offered[j] == preference[i]) && (find_suite(preference[i]) != NULL))
+            {
+                chosen = preference[i];
+            }
+        }
+    }
+
+    return chosen;
+}
+
+void session_crypto_init(session_crypto_ctx_t *ctx)
+{
+    ctx->suite = NULL;
+}
+
+bool session_crypto_set_key(session_crypto_ctx_t *ctx, session_suite_t suite, const uint8_t *key)
+{
+    const session_crypto_suite_t *found = find_suite(suite);
+
+    session_crypto_clear(ctx);
+
+    // Expands the key and precomputes the tables of the mode, once for all messages
+    if (found != NULL)
+    {
+        if (found->set_key(ctx, key, found->key_size))
+        {
+            ctx->suite = found;
+        }
+        else
+        {
+            found->free(ctx);
+        }
+    }
+
+    return (ctx->suite != NULL);
+}
+
+bool session_crypto_generate_key(session_crypto_ctx_t *ctx, session_suite_t suite)
+{
+    bool status = false;
+    uint8_t key[SESSION_CRYPTO_KEY_SIZE];
+
+    if (PSA_SUCCESS == psa_generate_random(key, sizeof(key)))
+    {
+        status = session_crypto_set_key(ctx, suite, key);
+    }
+
+    memset(key, 0, sizeof(key));
+
+    return status;
+}
+
+void session_crypto_clear(session_crypto_ctx_t *ctx)
+{
+    if (ctx->suite != NULL)
+    {
+        ctx->suite->free(ctx);
+        ctx->suite = NULL;
+    }
+}
+
+bool session_crypto_encrypt(session_crypto_ctx_t *ctx, const uint8_t *iv, const uint8_t *aad, size_t aad_len,
+                            const uint8_t *plaintext, size_t len, uint8_t *cipher)
+{
+    return (ctx->suite != NULL) &&
+           ctx->suite->encrypt(ctx, iv, aad, aad_len, plaintext, len, cipher, cipher + len);
+}
+
+bool session_crypto_decrypt(session_crypto_ctx_t *ctx, const uint8_t *iv, const uint8_t *aad, size_t aad_len,
+                            const uint8_t *cipher, size_t cipher_len, uint8_t *plaintext)
+{
+    size_t len = cipher_len - SESSION_CRYPTO_TAG_SIZE;
+
+    return (ctx->suite != NULL) && (cipher_len >= SESSION_CRYPTO_TAG_SIZE) &&
+           ctx->suite->decrypt(ctx, iv, aad, aad_len, cipher, len, plaintext, cipher + len);
+}
+
+static bool gcm_set_key(session_crypto_ctx_t *ctx, const uint8_t *key, size_t key_size)
+{
+    mbedtls_gcm_init(&ctx->aead.gcm);
+
+    return (0 == mbedtls_gcm_setkey(&ctx->aead.gcm, MBEDTLS_CIPHER_ID_AES, key, key_size * 8));
+}
+
+static bool gcm_encrypt(session_crypto_ctx_t *ctx, const uint8_t *iv, const uint8_t *aad, size_t aad_len,
+                        const uint8_t *input, size_t len, uint8_t *output, uint8_t *tag)
+{
+    return (0 == mbedtls_gcm_crypt_and_tag(&ctx->aead.gcm, MBEDTLS_GCM_ENCRYPT, len, iv, SESSION_CRYPTO_IV_SIZE,
+                                           aad, aad_len, input, output, SESSION_CRYPTO_TAG_SIZE, tag));
+}
+
+static bool gcm_decrypt(session_crypto_ctx_t *ctx, const uint8_t *iv, const uint8_t *aad, size_t aad_len,
+                        const uint8_t *input, size_t len, uint8_t *output, const uint8_t *tag)
+{
+    return (0 == mbedtls_gcm_auth_decrypt(&ctx->aead.gcm, len, iv, SESSION_CRYPTO_IV_SIZE,
+                                          aad, aad_len, tag, SESSION_CRYPTO_TAG_SIZE, input, output));
+}
+
+static void gcm_free(session_crypto_ctx_t *ctx)
+{
+    mbedtls_gcm_free(&ctx->aead.gcm);
+}
+
+static bool ccm_set_key(session_crypto_ctx_t *ctx, const uint8_t *key, size_t key_size)
+{
+    mbedtls_ccm_init(&ctx->aead.ccm);
+
+    return (0 == mbedtls_ccm_setkey(&ctx->aead.ccm, MBEDTLS_CIPHER_ID_AES, key, key_size * 8));
+}
+
+static bool ccm_encrypt(session_crypto_ctx_t *ctx, const uint8_t *iv, const uint8_t *aad, size_t aad_len,
+                        const uint8_t *input, size_t len, uint8_t *output, uint8_t *tag)
+{
+    return (0 == mbedtls_ccm_encrypt_and_tag(&ctx->aead.ccm, len, iv, SESSION_CRYPTO_IV_SIZE,
+                                             aad, aad_len, input, output, tag, SESSION_CRYPTO_TAG_SIZE));
+}
+
+static bool ccm_decrypt(session_crypto_ctx_t *ctx, const uint8_t *iv, const uint8_t *aad, size_t aad_len,
+                        const uint8_t *input, size_t len, uint8_t *output, const uint8_t *tag)
+{
+    return (0 == mbedtls_ccm_auth_decrypt(&ctx->aead.ccm, len, iv, SESSION_CRYPTO_IV_SIZE,
+                                          aad, aad_len, input, output, tag, SESSION_CRYPTO_TAG_SIZE));
+}
+
+static void ccm_free(session_crypto_ctx_t *ctx)
+{
+    mbedtls_ccm_free(&ctx->aead.ccm);
+}
+
+#if defined(MBEDTLS_CHACHAPOLY_C)
+static bool chachapoly_set_key(session_crypto_ctx_t *ctx, const uint8_t *key, size_t key_size)
+{
+    (void)key_size;
+    mbedtls_chachapoly_init(&ctx->aead.chachapoly);
+
+    return (0 == mbedtls_chachapoly_setkey(&ctx->aead.chachapoly, key));
+}
+
+static bool chachapoly_encrypt(session_crypto_ctx_t *ctx, const uint8_t *iv, const uint8_t *aad, size_t aad_len,
+                               const uint8_t *input, size_t len, uint8_t *output, uint8_t *tag)
+{
+    return (0 == mbedtls_chachapoly_encrypt_and_tag(&ctx->aead.chachapoly, len, iv, aad, aad_len, input, output, tag));
+}
+
+static bool chachapoly_decrypt(session_crypto_ctx_t *ctx, const uint8_t *iv, const uint8_t *aad, size_t aad_len,
+                               const uint8_t *input, size_t len, uint8_t *output, const uint8_t *tag)
+{
+    return (0 == mbedtls_chachapoly_auth_decrypt(&ctx->aead.chachapoly, len, iv, aad, aad_len, tag, input, output));
+}
+
+static void chachapoly_free(session_crypto_ctx_t *ctx)
+{
+    mbedtls_chachapoly_free(&ctx->aead.chachapoly);
+}
+#endif
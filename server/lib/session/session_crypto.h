@@ -0,0 +1,154 @@
+#ifndef SESSION_CRYPTO_H
+#define SESSION_CRYPTO_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <mbedtls/gcm.h>
+#include <mbedtls/ccm.h>
+#include <mbedtls/chachapoly.h>
+
+#define SESSION_CRYPTO_KEY_SIZE 32
+#define SESSION_CRYPTO_IV_SIZE 12
+#define SESSION_CRYPTO_TAG_SIZE 16
+
+/*
+ * AEAD of the session messages and resumption tickets. Every suite uses
+ * a 12 byte nonce and a 16 byte tag, so only the algorithm changes with
+ * the suite and not the message layout. A context holds the expanded key
+ * of one suite, set up once per key and reused for every message. Kept
+ * apart from the protocol so the same path can be benchmarked on the
+ * host and on the target.
+ */
+
+/*
+ * Identifiers sent in the handshake. Suites with a 16 byte key use the
+ * first half of the SESSION_CRYPTO_KEY_SIZE bytes of key material.
+ */
+typedef enum
+{
+    SESSION_SUITE_NONE = 0,
+    SESSION_SUITE_AES_128_GCM = 1,
+    SESSION_SUITE_AES_256_GCM = 2,
+    SESSION_SUITE_CHACHA20_POLY1305 = 3,
+    SESSION_SUITE_AES_128_CCM = 4,
+} session_suite_t;
+
+#define SESSION_SUITE_COUNT 4
+
+// Suites the device picks from, most preferred first. Reorder after running bench_aead on the target.
+#ifndef SESSION_CRYPTO_PREFERENCE
+#define SESSION_CRYPTO_PREFERENCE SESSION_SUITE_AES_256_GCM, SESSION_SUITE_AES_128_GCM, \
+                                  SESSION_SUITE_CHACHA20_POLY1305, SESSION_SUITE_AES_128_CCM
+#endif
+
+typedef struct session_crypto_suite session_crypto_suite_t;
+
+typedef struct
+{
+    const session_crypto_suite_t *suite; // NULL while the context has no key
+    union
+    {
+        mbedtls_gcm_context gcm;
+        mbedtls_ccm_context ccm;
+#if defined(MBEDTLS_CHACHAPOLY_C)
+        mbedtls_chachapoly_context chachapoly;
+#endif
+    } aead;
+} session_crypto_ctx_t;
+
+/**
+ * @brief Name of a suite built into this firmware.
+ *
+ * @param suite Suite identifier
+ *
+ * @return Name of the suite, NULL if it is unknown or not built in
+ */
+const char *session_crypto_suite_name(session_suite_t suite);
+
+/**
+ * @brief Pick the suite of a session from the ones a client offers.
+ *
+ * @param offered Suite identifiers offered by the client, in any order
+ * @param count   Number of offered suites
+ *
+ * @return The most preferred built-in suite that was offered,
+ *         SESSION_SUITE_NONE if there is none
+ */
+session_suite_t session_crypto_choose(const uint8_t *offered, size_t count);
+
+/**
+ * @brief Prepare a context without a key.
+ *
+ * @param ctx Context to prepare
+ */
+void session_crypto_init(session_crypto_ctx_t *ctx);
+
+/**
+ * @brief Set the suite and key of a context, replacing any previous ones.
+ *
+ * The key material is not kept outside the context, so the caller may
+ * wipe it afterwards.
+ *
+ * @param ctx   Context to set the key of
+ * @param suite Suite to encrypt with
+ * @param key   SESSION_CRYPTO_KEY_SIZE bytes of key material
+ *
+ * @return true  If the key was set
+ * @return false Otherwise, the context has no key
+ */
+bool session_crypto_set_key(session_crypto_ctx_t *ctx, session_suite_t suite, const uint8_t *key);
+
+/**
+ * @brief Set a random key that never leaves the device.
+ *
+ * @param ctx   Context to set the key of
+ * @param suite Suite to encrypt with
+ *
+ * @return true  If the key was generated and set
+ * @return false Otherwise, the context has no key
+ */
+bool session_crypto_generate_key(session_crypto_ctx_t *ctx, session_suite_t suite);
+
+/**
+ * @brief Wipe the key of a context, which can then be keyed again.
+ *
+ * @param ctx Context to clear
+ */
+void session_crypto_clear(session_crypto_ctx_t *ctx);
+
+/**
+ * @brief Encrypt and authenticate a message.
+ *
+ * @param ctx       Keyed context
+ * @param iv        SESSION_CRYPTO_IV_SIZE bytes of nonce
+ * @param aad       Additional authenticated data, may be NULL if aad_len is 0
+ * @param aad_len   Length of aad
+ * @param plaintext Message to encrypt
+ * @param len       Length of plaintext
+ * @param cipher    Receives len + SESSION_CRYPTO_TAG_SIZE bytes, may be plaintext to encrypt in place
+ *
+ * @return true  If the message was encrypted
+ * @return false Otherwise
+ */
+bool session_crypto_encrypt(session_crypto_ctx_t *ctx, const uint8_t *iv, const uint8_t *aad, size_t aad_len,
+                            const uint8_t *plaintext, size_t len, uint8_t *cipher);
+
+/**
+ * @brief Authenticate and decrypt a message.
+ *
+ * @param ctx        Keyed context
+ * @param iv         SESSION_CRYPTO_IV_SIZE bytes of nonce
+ * @param aad        Additional authenticated data, may be NULL if aad_len is 0
+ * @param aad_len    Length of aad
+ * @param cipher     Ciphertext followed by the tag
+ * @param cipher_len Length of cipher, at least SESSION_CRYPTO_TAG_SIZE
+ * @param plaintext  Receives cipher_len - SESSION_CRYPTO_TAG_SIZE bytes, may be cipher to decrypt in place
+ *
+ * @return true  If the tag matched
+ * @return false Otherwise, plaintext must not be used
+ */
+bool session_crypto_decrypt(session_crypto_ctx_t *ctx, const uint8_t *iv, const uint8_t *aad, size_t aad_len,
+                            const uint8_t *cipher, size_t cipher_len, uint8_t *plaintext);
+
+#endif
@@ -9,6 +9,7 @@
 #include "esp_err.h"
 #include "led_strip_rmt.h"
 #include "led_strip_spi.h"
+#include "led_strip_hsv.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -50,6 +51,42 @@ esp_err_t led_strip_set_pixel(led_strip_handle_t strip, uint32_t index, uint32_t
  */
 esp_err_t led_strip_set_pixel_rgbw(led_strip_handle_t strip, uint32_t index, uint32_t red, uint32_t green, uint32_t blue, uint32_t white);
 
+/**
+ * @brief Set RGB for a run of consecutive pixels
+ *
+ * @note The white component of RGBW strips is cleared, as with `led_strip_set_pixel`
+ *
+ * @param strip: LED strip
+ * @param start: index of the first pixel to set
+ * @param count: number of pixels to set
+ * @param rgb: R, G, B bytes of each pixel, 3 * count bytes in total
+ *
+ * @return
+ *      - ESP_OK: Set RGB for the pixels successfully
+ *      - ESP_ERR_INVALID_ARG: Set RGB for the pixels failed because of invalid parameters
+ *      - ESP_FAIL: Set RGB for the pixels failed because other error occurred
+ */
+esp_err_t led_strip_set_pixels(led_strip_handle_t strip, uint32_t start, uint32_t count, const uint8_t *rgb);
+
+/**
+ * @brief Set a run of consecutive pixels to the same RGB
+ *
+ * @note The color is encoded once and copied to the rest of the run
+ *
+ * @param strip: LED strip
+ * @param start: index of the first pixel to set
+ * @param count: number of pixels to set
+ * @param red: red part of color
+ * @param green: green part of color
+ * @param blue: blue part of color
+ *
+ * @return
+ *      - ESP_OK: Set RGB for the pixels successfully
+ *      - ESP_ERR_INVALID_ARG: Set RGB for the pixels failed because of invalid parameters
+ *      - ESP_FAIL: Set RGB for the pixels failed because other error occurred
+ */
+esp_err_t led_strip_fill(led_strip_handle_t strip, uint32_t start, uint32_t count, uint32_t red, uint32_t green, uint32_t blue);
+
 /**
  * @brief Set HSV for a specific pixel
  *
@@ -66,6 +103,54 @@ esp_err_t led_strip_set_pixel_rgbw(led_strip_handle_t strip, uint32_t index, uin
  */
 esp_err_t led_strip_set_pixel_hsv(led_strip_handle_t strip, uint32_t index, uint16_t hue, uint8_t saturation, uint8_t value);
 
+/**
+ * @brief Set the gamma curve of the strip
+ *
+ * @note The curve is turned into a lookup table once and applied while pixels are encoded,
+ *       so it affects the pixels set afterwards. Strips start out linear.
+ *
+ * @param strip: LED strip
+ * @param gamma: gamma exponent, out = 255 * (in / 255) ^ gamma, e.g. 2.2 for perceptual brightness
+ *
+ * @return
+ *      - ESP_OK: Set gamma successfully
+ *      - ESP_ERR_INVALID_ARG: Set gamma failed because of an invalid argument
+ */
+esp_err_t led_strip_set_gamma(led_strip_handle_t strip, float gamma);
+
+/**
+ * @brief Set the global brightness of the strip
+ *
+ * @note Applied together with the gamma curve while pixels are encoded, so it affects the pixels set afterwards.
+ *       Strips start out at full brightness.
+ *
+ * @param strip: LED strip
+ * @param brightness: 0 - 255, 255 is full scale
+ *
+ * @return
+ *      - ESP_OK: Set brightness successfully
+ *      - ESP_ERR_INVALID_ARG: Set brightness failed because of an invalid argument
+ */
+esp_err_t led_strip_set_brightness(led_strip_handle_t strip, uint8_t brightness);
+
+/**
+ * @brief Set HSV for a run of consecutive pixels
+ *
+ * @note The pixels are converted with integer arithmetic in chunks and handed to the bulk encoder,
+ *       which is much cheaper than calling `led_strip_set_pixel_hsv` per pixel
+ *
+ * @param strip: LED strip
+ * @param start: index of the first pixel to set
+ * @param count: number of pixels to set
+ * @param hsv: HSV color of each pixel
+ *
+ * @return
+ *      - ESP_OK: Set HSV color for the pixels successfully
+ *      - ESP_ERR_INVALID_ARG: Set HSV color for the pixels failed because of an invalid argument
+ *      - ESP_FAIL: Set HSV color for the pixels failed because other error occurred
+ */
+esp_err_t led_strip_set_pixels_hsv(led_strip_handle_t strip, uint32_t start, uint32_t count, const led_strip_hsv_t *hsv);
+
 /**
  * @brief Refresh memory colors to LEDs
  *
@@ -80,6 +165,34 @@ esp_err_t led_strip_set_pixel_hsv(led_strip_handle_t strip, uint32_t index, uint
  */
 esp_err_t led_strip_refresh(led_strip_handle_t strip);
 
+/**
+ * @brief Start flushing memory colors to LEDs and return without waiting for the transfer
+ *
+ * @note With a double-buffered SPI strip the next frame can be set while this one is sent.
+ *       Otherwise setting a pixel waits for the transfer first.
+ *       Backends without asynchronous refresh fall back to `led_strip_refresh`.
+ *
+ * @param strip: LED strip
+ *
+ * @return
+ *      - ESP_OK: Refresh started successfully
+ *      - ESP_FAIL: Refresh failed because some other error occurred
+ */
+esp_err_t led_strip_refresh_async(led_strip_handle_t strip);
+
+/**
+ * @brief Wait for the refresh started by `led_strip_refresh_async` to finish
+ *
+ * @param strip: LED strip
+ * @param timeout_ms: timeout value, -1 waits forever
+ *
+ * @return
+ *      - ESP_OK: No refresh is in flight any more
+ *      - ESP_ERR_TIMEOUT: The refresh did not finish in time
+ *      - ESP_FAIL: Wait failed because some other error occurred
+ */
+esp_err_t led_strip_wait_refresh_done(led_strip_handle_t strip, int timeout_ms);
+
 /**
  * @brief Clear LED strip (turn off all LEDs)
  *
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief HSV color of one pixel
+ */
+typedef struct {
+    uint16_t hue;       /*!< hue part of color (0 - 360) */
+    uint8_t saturation; /*!< saturation part of color (0 - 255) */
+    uint8_t value;      /*!< value part of color (0 - 255) */
+} led_strip_hsv_t;
+
+/**
+ * @brief Convert HSV pixels to R, G, B byte triplets
+ *
+ * @note Integer only: the hue picks a sextant from a table telling which component is at the maximum,
+ *       at the minimum, rising or falling. The result matches `led_strip_set_pixel_hsv`.
+ *
+ * @param hsv: pixels to convert
+ * @param rgb: R, G, B bytes of each pixel, 3 * count bytes in total
+ * @param count: number of pixels
+ */
+void led_strip_hsv_to_rgb(const led_strip_hsv_t *hsv, uint8_t *rgb, uint32_t count);
+
+#ifdef __cplusplus
+}
+#endif
@@ -51,6 +51,38 @@ struct led_strip_t {
      */
     esp_err_t (*set_pixel_rgbw)(led_strip_t *strip, uint32_t index, uint32_t red, uint32_t green, uint32_t blue, uint32_t white);
 
+    /**
+     * @brief Set RGB for a run of consecutive pixels
+     *
+     * @param strip: LED strip
+     * @param start: index of the first pixel to set
+     * @param count: number of pixels to set
+     * @param rgb: R, G, B bytes of each pixel, 3 * count bytes in total
+     *
+     * @return
+     *      - ESP_OK: Set RGB for the pixels successfully
+     *      - ESP_ERR_INVALID_ARG: Set RGB for the pixels failed because the run exceeds the strip
+     *      - ESP_FAIL: Set RGB for the pixels failed because other error occurred
+     */
+    esp_err_t (*set_pixels)(led_strip_t *strip, uint32_t start, uint32_t count, const uint8_t *rgb);
+
+    /**
+     * @brief Set a run of consecutive pixels to the same RGB
+     *
+     * @param strip: LED strip
+     * @param start: index of the first pixel to set
+     * @param count: number of pixels to set
+     * @param red: red part of color
+     * @param green: green part of color
+     * @param blue: blue part of color
+     *
+     * @return
+     *      - ESP_OK: Set RGB for the pixels successfully
+     *      - ESP_ERR_INVALID_ARG: Set RGB for the pixels failed because the run exceeds the strip
+     *      - ESP_FAIL: Set RGB for the pixels failed because other error occurred
+     */
+    esp_err_t (*fill)(led_strip_t *strip, uint32_t start, uint32_t count, uint32_t red, uint32_t green, uint32_t blue);
+
     /**
      * @brief Refresh memory colors to LEDs
      *
@@ -66,6 +98,59 @@ struct led_strip_t {
      */
     esp_err_t (*refresh)(led_strip_t *strip);
 
+    /**
+     * @brief Set the gamma curve applied to pixels set from now on
+     *
+     * @param strip: LED strip
+     * @param gamma: gamma exponent, 1.0 is linear
+     *
+     * @return
+     *      - ESP_OK: Set gamma successfully
+     *      - ESP_ERR_INVALID_ARG: Set gamma failed because the exponent is not positive
+     */
+    esp_err_t (*set_gamma)(led_strip_t *strip, float gamma);
+
+    /**
+     * @brief Set the global brightness applied to pixels set from now on
+     *
+     * @param strip: LED strip
+     * @param brightness: 0 - 255, 255 is full scale
+     *
+     * @return
+     *      - ESP_OK: Set brightness successfully
+     */
+    esp_err_t (*set_brightness)(led_strip_t *strip, uint8_t brightness);
+
+    /**
+     * @brief Start flushing memory colors to LEDs without waiting for the transfer to finish
+     *
+     * @param strip: LED strip
+     *
+     * @return
+     *      - ESP_OK: Refresh started successfully
+     *      - ESP_FAIL: Refresh failed because some other error occurred
+     *
+     * @note:
+     *      Optional, backends without it are refreshed synchronously by `led_strip_refresh_async`.
+     */
+    esp_err_t (*refresh_async)(led_strip_t *strip);
+
+    /**
+     * @brief Wait for the refresh started by `refresh_async` to finish
+     *
+     * @param strip: LED strip
+     * @param timeout_ms: timeout value, -1 waits forever
+     *
+     * @return
+     *      - ESP_OK: No refresh is in flight any more
+     *      - ESP_ERR_TIMEOUT: The refresh did not finish in time
+     *      - ESP_FAIL: Wait failed because some other error occurred
+     *
+     * @note:
+     *      Optional, only needed together with `refresh_async`.
+     */
+    esp_err_t (*wait_refresh_done)(led_strip_t *strip, int timeout_ms);
+
     /**
      * @brief Clear LED strip (turn off all LEDs)
      *
@@ -25,6 +25,8 @@ typedef struct {
     /*!< Extra RMT specific driver flags */
     struct led_strip_rmt_extra_config {
         uint32_t with_dma: 1;   /*!< Use DMA to transmit data */
+        uint32_t pre_encode: 1; /*!< Keep the whole frame encoded as RMT symbols and send it with a copy encoder, only written pixels are encoded again.
+                                     Without DMA (e.g. ESP32-C6) the driver refills the ping-pong channel memory from this buffer */
     } flags;                    /*!< Extra driver flags */
 } led_strip_rmt_config_t;
 
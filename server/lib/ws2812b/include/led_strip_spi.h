@@ -22,6 +22,7 @@ typedef struct {
     spi_host_device_t spi_bus;  /*!< SPI bus ID. Which buses are available depends on the specific chip */
     struct {
         uint32_t with_dma: 1;   /*!< Use DMA to transmit data */
+        uint32_t double_buffer: 1; /*!< Encode the next frame while the previous one is transmitted, requires `with_dma` */
     } flags;                    /*!< Extra driver flags */
 } led_strip_spi_config_t;
 
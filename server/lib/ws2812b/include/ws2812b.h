@@ -3,16 +3,133 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include "ws2812b_effect.h"
+
+#ifndef WS2812B_MAX_LEDS
+#define WS2812B_MAX_LEDS 64
+#endif
 
 #ifdef __cplusplus
 extern "C"
 {
 #endif
 
-    bool ws2812b_init(void);
+    /**
+     * @brief Create the strip and start its refresh task.
+     *
+     * @param gpio  GPIO connected to the data line of the strip
+     * @param count Number of LEDs, 1 to WS2812B_MAX_LEDS
+     *
+     * @return true  If the strip was created
+     * @return false Otherwise
+     */
+    bool ws2812b_init(int gpio, uint32_t count);
+
+    /**
+     * @brief Get the number of LEDs given to ws2812b_init().
+     */
+    uint32_t ws2812b_led_count(void);
 
+    /**
+     * @brief Set every LED of the strip to the same colour.
+     *
+     * Stops a running effect.
+     */
     void ws2812b_set_color(uint8_t _red, uint8_t _green, uint8_t _blue);
 
+    /**
+     * @brief Set a run of consecutive LEDs.
+     *
+     * The pixels are shown on the next refresh of the strip. Stops a
+     * running effect.
+     *
+     * @param start Index of the first LED
+     * @param count Number of LEDs
+     * @param rgb   R, G, B bytes of each LED, 3 * count bytes in total
+     *
+     * @return true  If the run fits within the strip
+     * @return false Otherwise
+     */
+    bool ws2812b_set_pixels(uint32_t start, uint32_t count, const uint8_t *rgb);
+
+    /**
+     * @brief Set the whole strip from a frame of R, G, B triplets.
+     *
+     * @param rgb Frame of 3 * ws2812b_led_count() bytes
+     */
+    void ws2812b_set_frame(const uint8_t *rgb);
+
+    /**
+     * @brief Set a run of consecutive LEDs to one colour.
+     *
+     * The colour is encoded into the strip once and copied along the run,
+     * without going through the frame. Stops a running effect.
+     *
+     * @param start Index of the first LED
+     * @param count Number of LEDs
+     * @param rgb   R, G, B bytes of the colour
+     *
+     * @return true  If the run fits within the strip and was written
+     * @return false Otherwise
+     */
+    bool ws2812b_fill(uint32_t start, uint32_t count, const uint8_t *rgb);
+
+    /**
+     * @brief Hold back refreshes until ws2812b_end_update().
+     *
+     * Lets a frame made of several calls be shown at once. The calls
+     * must come from the task that called ws2812b_begin_update().
+     */
+    void ws2812b_begin_update(void);
+
+    /**
+     * @brief Show the changes made since ws2812b_begin_update().
+     */
+    void ws2812b_end_update(void);
+
+    /**
+     * @brief Start rendering an effect.
+     *
+     * The refresh task renders a frame every effect->frame_ms until the
+     * effect is replaced, or the pixels are set directly. The effect
+     * starts at the beginning of its cycle.
+     *
+     * @param _effect Effect to run, WS2812B_EFFECT_NONE freezes the current frame
+     */
+    void ws2812b_set_effect(const ws2812b_effect_t *_effect);
+
+    /**
+     * @brief Set the gamma curve of the strip.
+     *
+     * The curve is applied while the frame is encoded, through a table
+     * built once here. The strip starts out linear.
+     *
+     * @param gamma Gamma exponent, e.g. 2.2 for perceptual brightness
+     *
+     * @return true  If the gamma was set
+     * @return false If it is not positive
+     */
+    bool ws2812b_set_gamma(float gamma);
+
+    /**
+     * @brief Scale the whole strip to the given brightness.
+     *
+     * @param brightness 0 to 255, 255 being full brightness
+     */
+    void ws2812b_set_brightness(uint8_t brightness);
+
+    /**
+     * @brief Select when the strip is refreshed.
+     *
+     * By default the strip is only refreshed when its pixels change. A
+     * non-zero period refreshes it at that fixed rate instead, which
+     * paces animations that change the frame every period. A running
+     * effect uses its own frame rate.
+     *
+     * @param period_ms Refresh period, rounded up to at least one tick, 0 refreshes on change only
+     */
+    void ws2812b_set_refresh_period(uint32_t period_ms);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,48 @@
+#ifndef WS2812B_EFFECT_H
+#define WS2812B_EFFECT_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    typedef enum
+    {
+        WS2812B_EFFECT_NONE = 0,     // the frame is set directly
+        WS2812B_EFFECT_FADE = 1,     // whole strip fades from -> to -> from
+        WS2812B_EFFECT_BLINK = 2,    // whole strip shows from, then to, each for half a period
+        WS2812B_EFFECT_CHASE = 3,    // one to pixel runs along a from background
+        WS2812B_EFFECT_GRADIENT = 4, // from -> to -> from gradient scrolling along the strip
+    } ws2812b_effect_type_t;
+
+    typedef struct
+    {
+        ws2812b_effect_type_t type;
+        uint8_t from[3];    // R, G, B of the first colour
+        uint8_t to[3];      // R, G, B of the second colour
+        uint16_t period_ms; // length of one cycle of the effect
+        uint16_t frame_ms;  // time between rendered frames, 0 selects WS2812B_EFFECT_FRAME_MS
+    } ws2812b_effect_t;
+
+#define WS2812B_EFFECT_FRAME_MS 20
+
+    /**
+     * @brief Render one frame of an effect.
+     *
+     * Only integer arithmetic is used. Colours are blended with 8-bit
+     * fractional weights, so one cycle has up to 512 distinct steps.
+     *
+     * @param effect     Effect to render
+     * @param elapsed_ms Time since the effect was started
+     * @param rgb        Frame of 3 * led_count bytes to render into
+     * @param led_count  Number of LEDs in the frame
+     */
+    void ws2812b_effect_render(const ws2812b_effect_t *effect, uint32_t elapsed_ms, uint8_t *rgb, uint32_t led_count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -8,6 +8,8 @@
 #include "led_strip.h"
 #include "led_strip_interface.h"
 
+#define LED_STRIP_HSV_CHUNK 32
+
 static const char *TAG = "led_strip";
 
 esp_err_t led_strip_set_pixel(led_strip_handle_t strip, uint32_t index, uint32_t red, uint32_t green, uint32_t blue)
@@ -16,57 +18,49 @@ esp_err_t led_strip_set_pixel(led_strip_handle_t strip, uint32_t index, uint32_t
     return strip->set_pixel(strip, index, red, green, blue);
 }
 
+esp_err_t led_strip_set_pixels(led_strip_handle_t strip, uint32_t start, uint32_t count, const uint8_t *rgb)
+{
+    ESP_RETURN_ON_FALSE(strip && (rgb || count == 0), ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    return strip->set_pixels(strip, start, count, rgb);
+}
+
+esp_err_t led_strip_fill(led_strip_handle_t strip, uint32_t start, uint32_t count, uint32_t red, uint32_t green, uint32_t blue)
+{
+    ESP_RETURN_ON_FALSE(strip, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    return strip->fill(strip, start, count, red, green, blue);
+}
+
 esp_err_t led_strip_set_pixel_hsv(led_strip_handle_t strip, uint32_t index, uint16_t hue, uint8_t saturation, uint8_t value)
 {
     ESP_RETURN_ON_FALSE(strip, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
 
-    uint32_t red = 0;
-    uint32_t green = 0;
-    uint32_t blue = 0;
-
-    uint32_t rgb_max = value;
-    uint32_t rgb_min = rgb_max * (255 - saturation) / 255.0f;
-
-    uint32_t i = hue / 60;
-    uint32_t diff = hue % 60;
-
-    // RGB adjustment amount by hue
-    uint32_t rgb_adj = (rgb_max - rgb_min) * diff / 60;
-
-    switch (i) {
-    case 0:
-        red = rgb_max;
-        green = rgb_min + rgb_adj;
-        blue = rgb_min;
-        break;
-    case 1:
-        red = rgb_max - rgb_adj;
-        green = rgb_max;
-        blue = rgb_min;
-        break;
-    case 2:
-        red = rgb_min;
-        green = rgb_max;
-        blue = rgb_min + rgb_adj;
-        break;
-    case 3:
-        red = rgb_min;
-        green = rgb_max - rgb_adj;
-        blue = rgb_max;
-        break;
-    case 4:
-        red = rgb_min + rgb_adj;
-        green = rgb_min;
-        blue = rgb_max;
-        break;
-    default:
-        red = rgb_max;
-        green = rgb_min;
-        blue = rgb_max - rgb_adj;
-        break;
+    const led_strip_hsv_t hsv = {
+        .hue = hue,
+        .saturation = saturation,
+        .value = value,
+    };
+    uint8_t rgb[3];
+    led_strip_hsv_to_rgb(&hsv, rgb, 1);
+
+    return strip->set_pixel(strip, index, rgb[0], rgb[1], rgb[2]);
+}
+
+esp_err_t led_strip_set_pixels_hsv(led_strip_handle_t strip, uint32_t start, uint32_t count, const led_strip_hsv_t *hsv)
+{
+    ESP_RETURN_ON_FALSE(strip && (hsv || count == 0), ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+
+    // convert a chunk at a time on the stack, and hand each chunk to the bulk encoder
+    uint8_t rgb[LED_STRIP_HSV_CHUNK * 3];
+    while (count > 0) {
+        uint32_t chunk = count < LED_STRIP_HSV_CHUNK ? count : LED_STRIP_HSV_CHUNK;
+        led_strip_hsv_to_rgb(hsv, rgb, chunk);
+        ESP_RETURN_ON_ERROR(strip->set_pixels(strip, start, chunk, rgb), TAG, "set pixels failed");
+        start += chunk;
+        count -= chunk;
+        hsv += chunk;
     }
 
-    return strip->set_pixel(strip, index, red, green, blue);
+    return ESP_OK;
 }
 
 esp_err_t led_strip_set_pixel_rgbw(led_strip_handle_t strip, uint32_t index, uint32_t red, uint32_t green, uint32_t blue, uint32_t white)
@@ -75,12 +69,42 @@ esp_err_t led_strip_set_pixel_rgbw(led_strip_handle_t strip, uint32_t index, uin
     return strip->set_pixel_rgbw(strip, index, red, green, blue, white);
 }
 
+esp_err_t led_strip_set_gamma(led_strip_handle_t strip, float gamma)
+{
+    ESP_RETURN_ON_FALSE(strip, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    return strip->set_gamma(strip, gamma);
+}
+
+esp_err_t led_strip_set_brightness(led_strip_handle_t strip, uint8_t brightness)
+{
+    ESP_RETURN_ON_FALSE(strip, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    return strip->set_brightness(strip, brightness);
+}
+
 esp_err_t led_strip_refresh(led_strip_handle_t strip)
 {
     ESP_RETURN_ON_FALSE(strip, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
     return strip->refresh(strip);
 }
 
+esp_err_t led_strip_refresh_async(led_strip_handle_t strip)
+{
+    ESP_RETURN_ON_FALSE(strip, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    if (!strip->refresh_async) {
+        return strip->refresh(strip);
+    }
+    return strip->refresh_async(strip);
+}
+
+esp_err_t led_strip_wait_refresh_done(led_strip_handle_t strip, int timeout_ms)
+{
+    ESP_RETURN_ON_FALSE(strip, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    if (!strip->wait_refresh_done) {
+        return ESP_OK;
+    }
+    return strip->wait_refresh_done(strip, timeout_ms);
+}
+
 esp_err_t led_strip_clear(led_strip_handle_t strip)
 {
     ESP_RETURN_ON_FALSE(strip, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
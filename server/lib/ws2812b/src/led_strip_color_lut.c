@@ -0,0 +1,37 @@
+#include <math.h>
+#include "led_strip_color_lut.h"
+
+static void led_strip_color_lut_rebuild(led_strip_color_lut_t *color_lut)
+{
+    for (uint32_t i = 0; i < 256; i++) {
+        color_lut->lut[i] = (color_lut->gamma[i] * color_lut->brightness + 127) / 255;
+    }
+}
+
+void led_strip_color_lut_init(led_strip_color_lut_t *color_lut)
+{
+    for (uint32_t i = 0; i < 256; i++) {
+        color_lut->gamma[i] = i;
+    }
+    color_lut->brightness = 255;
+    led_strip_color_lut_rebuild(color_lut);
+}
+
+esp_err_t led_strip_color_lut_set_gamma(led_strip_color_lut_t *color_lut, float gamma)
+{
+    if (!(gamma > 0.0f)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    // float is only used here, once per configuration, never per pixel
+    for (uint32_t i = 0; i < 256; i++) {
+        color_lut->gamma[i] = (uint8_t)(255.0f * powf(i / 255.0f, gamma) + 0.5f);
+    }
+    led_strip_color_lut_rebuild(color_lut);
+    return ESP_OK;
+}
+
+void led_strip_color_lut_set_brightness(led_strip_color_lut_t *color_lut, uint8_t brightness)
+{
+    color_lut->brightness = brightness;
+    led_strip_color_lut_rebuild(color_lut);
+}
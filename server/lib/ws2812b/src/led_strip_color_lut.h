@@ -0,0 +1,48 @@
+#pragma once
+
+#include <stdint.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Per strip color correction, applied while pixels are encoded
+ */
+typedef struct {
+    uint8_t lut[256];   /*!< Gamma curve scaled by the brightness, indexed by the raw color component */
+    uint8_t gamma[256]; /*!< Gamma curve alone, kept to rebuild `lut` when the brightness changes */
+    uint8_t brightness; /*!< Global brightness, 255 is full scale */
+} led_strip_color_lut_t;
+
+/**
+ * @brief Reset the color correction to linear at full brightness
+ *
+ * @param color_lut: color correction to reset
+ */
+void led_strip_color_lut_init(led_strip_color_lut_t *color_lut);
+
+/**
+ * @brief Set the gamma curve, out = 255 * (in / 255) ^ gamma
+ *
+ * @param color_lut: color correction to update
+ * @param gamma: gamma exponent, 1.0 is linear
+ *
+ * @return
+ *      - ESP_OK: Gamma set successfully
+ *      - ESP_ERR_INVALID_ARG: Gamma is not positive
+ */
+esp_err_t led_strip_color_lut_set_gamma(led_strip_color_lut_t *color_lut, float gamma);
+
+/**
+ * @brief Set the global brightness
+ *
+ * @param color_lut: color correction to update
+ * @param brightness: 0 - 255, 255 is full scale
+ */
+void led_strip_color_lut_set_brightness(led_strip_color_lut_t *color_lut, uint8_t brightness);
+
+#ifdef __cplusplus
+}
+#endif
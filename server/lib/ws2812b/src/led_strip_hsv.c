@@ -0,0 +1,42 @@
+#include "led_strip_hsv.h"
+
+// The four levels a component can take, packed one byte each into a word
+#define LEVEL_MAX 0
+#define LEVEL_MIN 8
+#define LEVEL_RISING 16
+#define LEVEL_FALLING 24
+
+// Bit offset of the level taken by each of R, G, B in a sextant of 60 degrees
+static const uint8_t sextant_levels[6][3] = {
+    {LEVEL_MAX, LEVEL_RISING, LEVEL_MIN},
+    {LEVEL_FALLING, LEVEL_MAX, LEVEL_MIN},
+    {LEVEL_MIN, LEVEL_MAX, LEVEL_RISING},
+    {LEVEL_MIN, LEVEL_FALLING, LEVEL_MAX},
+    {LEVEL_RISING, LEVEL_MIN, LEVEL_MAX},
+    {LEVEL_MAX, LEVEL_MIN, LEVEL_FALLING},
+};
+
+void led_strip_hsv_to_rgb(const led_strip_hsv_t *hsv, uint8_t *rgb, uint32_t count)
+{
+    for (uint32_t i = 0; i < count; i++, hsv++, rgb += 3) {
+        uint32_t sextant = hsv->hue / 60;
+        uint32_t diff = hsv->hue - sextant * 60;
+        // hues past 360 stay in the last sextant
+        if (sextant > 5) {
+            diff = hsv->hue % 60;
+            sextant = 5;
+        }
+
+        uint32_t rgb_max = hsv->value;
+        uint32_t rgb_min = rgb_max * (255 - hsv->saturation) / 255;
+        // RGB adjustment amount by hue
+        uint32_t rgb_adj = (rgb_max - rgb_min) * diff / 60;
+        uint32_t levels = (rgb_max << LEVEL_MAX) | (rgb_min << LEVEL_MIN) |
+                          ((rgb_min + rgb_adj) << LEVEL_RISING) | ((rgb_max - rgb_adj) << LEVEL_FALLING);
+        const uint8_t *select = sextant_levels[sextant];
+
+        rgb[0] = levels >> select[0];
+        rgb[1] = levels >> select[1];
+        rgb[2] = levels >> select[2];
+    }
+}
@@ -8,10 +8,13 @@
 #include <sys/cdefs.h>
 #include "esp_log.h"
 #include "esp_check.h"
+#include "esp_heap_caps.h"
 #include "driver/rmt_tx.h"
+#include "soc/soc_caps.h"
 #include "led_strip.h"
 #include "led_strip_interface.h"
 #include "led_strip_rmt_encoder.h"
+#include "led_strip_color_lut.h"
 
 #define LED_STRIP_RMT_DEFAULT_RESOLUTION 10000000 // 10MHz resolution
 #define LED_STRIP_RMT_DEFAULT_TRANS_QUEUE_SIZE 4
@@ -31,9 +34,36 @@ typedef struct {
     uint32_t strip_len;
     uint8_t bytes_per_pixel;
     led_color_component_format_t component_fmt;
+    led_strip_color_lut_t color_lut;
+    rmt_symbol_word_t bit_symbols[2];
+    rmt_symbol_word_t *symbols; // pre-encoded frame followed by the reset code, NULL unless pre_encode is set
+    uint32_t dirty_start;       // pixels [dirty_start, dirty_end) were written since they were last encoded
+    uint32_t dirty_end;
     uint8_t pixel_buf[];
 } led_strip_rmt_obj;
 
+static inline void __led_strip_rmt_mark_dirty(led_strip_rmt_obj *rmt_strip, uint32_t start, uint32_t count)
+{
+    if (count > 0) {
+        rmt_strip->dirty_start = start < rmt_strip->dirty_start ? start : rmt_strip->dirty_start;
+        rmt_strip->dirty_end = start + count > rmt_strip->dirty_end ? start + count : rmt_strip->dirty_end;
+    }
+}
+
+static void __led_strip_rmt_encode(led_strip_rmt_obj *rmt_strip, uint32_t start, uint32_t count)
+{
+    const uint32_t stride = rmt_strip->bytes_per_pixel;
+    const uint8_t *buf = rmt_strip->pixel_buf + start * stride;
+    rmt_symbol_word_t *symbol = rmt_strip->symbols + start * stride * 8;
+    for (uint32_t i = 0; i < count * stride; i++) {
+        uint32_t byte = buf[i];
+        // MSB first, one symbol per bit
+        for (int bit = 7; bit >= 0; bit--) {
+            *symbol++ = rmt_strip->bit_symbols[(byte >> bit) & 0x01];
+        }
+    }
+}
+
 static esp_err_t led_strip_rmt_set_pixel(led_strip_t *strip, uint32_t index, uint32_t red, uint32_t green, uint32_t blue)
 {
     led_strip_rmt_obj *rmt_strip = __containerof(strip, led_strip_rmt_obj, base);
@@ -42,13 +72,15 @@ static esp_err_t led_strip_rmt_set_pixel(led_strip_t *strip, uint32_t index, uin
     led_color_component_format_t component_fmt = rmt_strip->component_fmt;
     uint32_t start = index * rmt_strip->bytes_per_pixel;
     uint8_t *pixel_buf = rmt_strip->pixel_buf;
+    const uint8_t *lut = rmt_strip->color_lut.lut;
 
-    pixel_buf[start + component_fmt.format.r_pos] = red & 0xFF;
-    pixel_buf[start + component_fmt.format.g_pos] = green & 0xFF;
-    pixel_buf[start + component_fmt.format.b_pos] = blue & 0xFF;
+    pixel_buf[start + component_fmt.format.r_pos] = lut[red & 0xFF];
+    pixel_buf[start + component_fmt.format.g_pos] = lut[green & 0xFF];
+    pixel_buf[start + component_fmt.format.b_pos] = lut[blue & 0xFF];
     if (component_fmt.format.num_components > 3) {
         pixel_buf[start + component_fmt.format.w_pos] = 0;
     }
+    __led_strip_rmt_mark_dirty(rmt_strip, index, 1);
 
     return ESP_OK;
 }
@@ -62,25 +94,107 @@ static esp_err_t led_strip_rmt_set_pixel_rgbw(led_strip_t *strip, uint32_t index
 
     uint32_t start = index * rmt_strip->bytes_per_pixel;
     uint8_t *pixel_buf = rmt_strip->pixel_buf;
+    const uint8_t *lut = rmt_strip->color_lut.lut;
+
+    pixel_buf[start + component_fmt.format.r_pos] = lut[red & 0xFF];
+    pixel_buf[start + component_fmt.format.g_pos] = lut[green & 0xFF];
+    pixel_buf[start + component_fmt.format.b_pos] = lut[blue & 0xFF];
+    pixel_buf[start + component_fmt.format.w_pos] = lut[white & 0xFF];
+    __led_strip_rmt_mark_dirty(rmt_strip, index, 1);
+
+    return ESP_OK;
+}
+
+static esp_err_t led_strip_rmt_set_pixels(led_strip_t *strip, uint32_t start, uint32_t count, const uint8_t *rgb)
+{
+    led_strip_rmt_obj *rmt_strip = __containerof(strip, led_strip_rmt_obj, base);
+    ESP_RETURN_ON_FALSE(start <= rmt_strip->strip_len && count <= rmt_strip->strip_len - start, ESP_ERR_INVALID_ARG, TAG, "pixels out of maximum number of LEDs");
+
+    led_color_component_format_t component_fmt = rmt_strip->component_fmt;
+    const uint32_t stride = rmt_strip->bytes_per_pixel;
+    const uint32_t r_pos = component_fmt.format.r_pos;
+    const uint32_t g_pos = component_fmt.format.g_pos;
+    const uint32_t b_pos = component_fmt.format.b_pos;
+    const uint32_t w_pos = component_fmt.format.w_pos;
+    const uint8_t *lut = rmt_strip->color_lut.lut;
+    uint8_t *buf = rmt_strip->pixel_buf + start * stride;
+
+    if (component_fmt.format.num_components > 3) {
+        for (uint32_t i = 0; i < count; i++, rgb += 3, buf += stride) {
+            buf[r_pos] = lut[rgb[0]];
+            buf[g_pos] = lut[rgb[1]];
+            buf[b_pos] = lut[rgb[2]];
+            buf[w_pos] = 0;
+        }
+    } else {
+        for (uint32_t i = 0; i < count; i++, rgb += 3, buf += stride) {
+            buf[r_pos] = lut[rgb[0]];
+            buf[g_pos] = lut[rgb[1]];
+            buf[b_pos] = lut[rgb[2]];
+        }
+    }
+    __led_strip_rmt_mark_dirty(rmt_strip, start, count);
+
+    return ESP_OK;
+}
 
-    pixel_buf[start + component_fmt.format.r_pos] = red & 0xFF;
-    pixel_buf[start + component_fmt.format.g_pos] = green & 0xFF;
-    pixel_buf[start + component_fmt.format.b_pos] = blue & 0xFF;
-    pixel_buf[start + component_fmt.format.w_pos] = white & 0xFF;
+static esp_err_t led_strip_rmt_fill(led_strip_t *strip, uint32_t start, uint32_t count, uint32_t red, uint32_t green, uint32_t blue)
+{
+    led_strip_rmt_obj *rmt_strip = __containerof(strip, led_strip_rmt_obj, base);
+    ESP_RETURN_ON_FALSE(start <= rmt_strip->strip_len && count <= rmt_strip->strip_len - start, ESP_ERR_INVALID_ARG, TAG, "pixels out of maximum number of LEDs");
+
+    if (count > 0) {
+        const uint8_t rgb[3] = {red, green, blue};
+        const uint32_t stride = rmt_strip->bytes_per_pixel;
+        uint8_t *buf = rmt_strip->pixel_buf + start * stride;
+        // set the first pixel, then keep doubling the filled part of the run
+        led_strip_rmt_set_pixels(strip, start, 1, rgb);
+        for (uint32_t done = 1; done < count; done *= 2) {
+            uint32_t copy = (count - done < done) ? count - done : done;
+            memcpy(buf + done * stride, buf, copy * stride);
+        }
+        __led_strip_rmt_mark_dirty(rmt_strip, start, count);
+    }
 
     return ESP_OK;
 }
 
+static esp_err_t led_strip_rmt_set_gamma(led_strip_t *strip, float gamma)
+{
+    led_strip_rmt_obj *rmt_strip = __containerof(strip, led_strip_rmt_obj, base);
+    ESP_RETURN_ON_ERROR(led_strip_color_lut_set_gamma(&rmt_strip->color_lut, gamma), TAG, "invalid gamma");
+    return ESP_OK;
+}
+
+static esp_err_t led_strip_rmt_set_brightness(led_strip_t *strip, uint8_t brightness)
+{
+    led_strip_rmt_obj *rmt_strip = __containerof(strip, led_strip_rmt_obj, base);
+    led_strip_color_lut_set_brightness(&rmt_strip->color_lut, brightness);
+    return ESP_OK;
+}
+
 static esp_err_t led_strip_rmt_refresh(led_strip_t *strip)
 {
     led_strip_rmt_obj *rmt_strip = __containerof(strip, led_strip_rmt_obj, base);
     rmt_transmit_config_t tx_conf = {
         .loop_count = 0,
     };
+    const void *data = rmt_strip->pixel_buf;
+    size_t data_size = rmt_strip->strip_len * rmt_strip->bytes_per_pixel;
+    if (rmt_strip->symbols) {
+        // only the pixels written since the last refresh are encoded again,
+        // the copy encoder then moves the whole frame, reset code included
+        if (rmt_strip->dirty_start < rmt_strip->dirty_end) {
+            __led_strip_rmt_encode(rmt_strip, rmt_strip->dirty_start, rmt_strip->dirty_end - rmt_strip->dirty_start);
+        }
+        rmt_strip->dirty_start = rmt_strip->strip_len;
+        rmt_strip->dirty_end = 0;
+        data = rmt_strip->symbols;
+        data_size = (data_size * 8 + 1) * sizeof(rmt_symbol_word_t);
+    }
 
     ESP_RETURN_ON_ERROR(rmt_enable(rmt_strip->rmt_chan), TAG, "enable RMT channel failed");
-    ESP_RETURN_ON_ERROR(rmt_transmit(rmt_strip->rmt_chan, rmt_strip->strip_encoder, rmt_strip->pixel_buf,
-                                     rmt_strip->strip_len * rmt_strip->bytes_per_pixel, &tx_conf), TAG, "transmit pixels by RMT failed");
+    ESP_RETURN_ON_ERROR(rmt_transmit(rmt_strip->rmt_chan, rmt_strip->strip_encoder, data, data_size, &tx_conf), TAG, "transmit pixels by RMT failed");
     ESP_RETURN_ON_ERROR(rmt_tx_wait_all_done(rmt_strip->rmt_chan, -1), TAG, "flush RMT channel failed");
     ESP_RETURN_ON_ERROR(rmt_disable(rmt_strip->rmt_chan), TAG, "disable RMT channel failed");
     return ESP_OK;
@@ -91,6 +205,7 @@ static esp_err_t led_strip_rmt_clear(led_strip_t *strip)
     led_strip_rmt_obj *rmt_strip = __containerof(strip, led_strip_rmt_obj, base);
     // Write zero to turn off all leds
     memset(rmt_strip->pixel_buf, 0, rmt_strip->strip_len * rmt_strip->bytes_per_pixel);
+    __led_strip_rmt_mark_dirty(rmt_strip, 0, rmt_strip->strip_len);
     return led_strip_rmt_refresh(strip);
 }
 
@@ -99,6 +214,9 @@ static esp_err_t led_strip_rmt_del(led_strip_t *strip)
     led_strip_rmt_obj *rmt_strip = __containerof(strip, led_strip_rmt_obj, base);
     ESP_RETURN_ON_ERROR(rmt_del_channel(rmt_strip->rmt_chan), TAG, "delete RMT channel failed");
     ESP_RETURN_ON_ERROR(rmt_del_encoder(rmt_strip->strip_encoder), TAG, "delete strip encoder failed");
+    if (rmt_strip->symbols) {
+        heap_caps_free(rmt_strip->symbols);
+    }
     free(rmt_strip);
     return ESP_OK;
 }
@@ -139,9 +257,17 @@ esp_err_t led_strip_new_rmt_device(const led_strip_config_t *led_config, const l
     }
     size_t mem_block_symbols = LED_STRIP_RMT_DEFAULT_MEM_BLOCK_SYMBOLS;
     // override the default value if the user sets it
+    size_t frame_symbols = led_config->max_leds * bytes_per_pixel * 8 + 1;
     if (rmt_config->mem_block_symbols) {
         mem_block_symbols = rmt_config->mem_block_symbols;
     }
+#if SOC_RMT_SUPPORT_DMA
+    // a DMA buffer holding the whole frame lets the copy encoder finish in one go, without refills from the ISR.
+    // Not built for the ESP32-C6, whose RMT has no DMA: pre-encoded frames go through the ping-pong channel memory there
+    else if (rmt_config->flags.pre_encode && rmt_config->flags.with_dma) {
+        mem_block_symbols = frame_symbols;
+    }
+#endif
     rmt_tx_channel_config_t rmt_chan_config = {
         .clk_src = clk_src,
         .gpio_num = led_config->strip_gpio_num,
@@ -157,14 +283,34 @@ esp_err_t led_strip_new_rmt_device(const led_strip_config_t *led_config, const l
         .resolution = resolution,
         .led_model = led_config->led_model
     };
-    ESP_GOTO_ON_ERROR(rmt_new_led_strip_encoder(&strip_encoder_conf, &rmt_strip->strip_encoder), err, TAG, "create LED strip encoder failed");
+    if (rmt_config->flags.pre_encode) {
+        led_strip_rmt_symbols_t strip_symbols;
+        ESP_GOTO_ON_ERROR(led_strip_rmt_get_symbols(&strip_encoder_conf, &strip_symbols), err, TAG, "get LED strip symbols failed");
+        uint32_t caps = rmt_config->flags.with_dma ? MALLOC_CAP_INTERNAL | MALLOC_CAP_DMA : MALLOC_CAP_DEFAULT;
+        rmt_strip->symbols = heap_caps_malloc(frame_symbols * sizeof(rmt_symbol_word_t), caps);
+        ESP_GOTO_ON_FALSE(rmt_strip->symbols, ESP_ERR_NO_MEM, err, TAG, "no mem for pre-encoded symbols");
+        rmt_strip->bit_symbols[0] = strip_symbols.bit0;
+        rmt_strip->bit_symbols[1] = strip_symbols.bit1;
+        rmt_strip->symbols[frame_symbols - 1] = strip_symbols.reset;
+        rmt_copy_encoder_config_t copy_encoder_config = {};
+        ESP_GOTO_ON_ERROR(rmt_new_copy_encoder(&copy_encoder_config, &rmt_strip->strip_encoder), err, TAG, "create copy encoder failed");
+    } else {
+        ESP_GOTO_ON_ERROR(rmt_new_led_strip_encoder(&strip_encoder_conf, &rmt_strip->strip_encoder), err, TAG, "create LED strip encoder failed");
+    }
 
     rmt_strip->component_fmt = component_fmt;
+    led_strip_color_lut_init(&rmt_strip->color_lut);
     rmt_strip->bytes_per_pixel = bytes_per_pixel;
     rmt_strip->strip_len = led_config->max_leds;
+    // the frame starts out black, encoded by the first refresh
+    __led_strip_rmt_mark_dirty(rmt_strip, 0, rmt_strip->strip_len);
     rmt_strip->base.set_pixel = led_strip_rmt_set_pixel;
     rmt_strip->base.set_pixel_rgbw = led_strip_rmt_set_pixel_rgbw;
+    rmt_strip->base.set_pixels = led_strip_rmt_set_pixels;
+    rmt_strip->base.fill = led_strip_rmt_fill;
     rmt_strip->base.refresh = led_strip_rmt_refresh;
+    rmt_strip->base.set_gamma = led_strip_rmt_set_gamma;
+    rmt_strip->base.set_brightness = led_strip_rmt_set_brightness;
     rmt_strip->base.clear = led_strip_rmt_clear;
     rmt_strip->base.del = led_strip_rmt_del;
 
@@ -178,6 +324,9 @@ err:
         if (rmt_strip->strip_encoder) {
             rmt_del_encoder(rmt_strip->strip_encoder);
         }
+        if (rmt_strip->symbols) {
+            heap_caps_free(rmt_strip->symbols);
+        }
         free(rmt_strip);
     }
     return ret;
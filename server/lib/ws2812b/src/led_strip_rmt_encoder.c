@@ -71,21 +71,12 @@ static esp_err_t rmt_led_strip_encoder_reset(rmt_encoder_t *encoder)
     return ESP_OK;
 }
 
-esp_err_t rmt_new_led_strip_encoder(const led_strip_encoder_config_t *config, rmt_encoder_handle_t *ret_encoder)
+static esp_err_t led_strip_rmt_timing(const led_strip_encoder_config_t *config, rmt_bytes_encoder_config_t *bytes_config, uint32_t *reset_ticks)
 {
-    esp_err_t ret = ESP_OK;
-    rmt_led_strip_encoder_t *led_encoder = NULL;
-    ESP_GOTO_ON_FALSE(config && ret_encoder, ESP_ERR_INVALID_ARG, err, TAG, "invalid argument");
-    ESP_GOTO_ON_FALSE(config->led_model < LED_MODEL_INVALID, ESP_ERR_INVALID_ARG, err, TAG, "invalid led model");
-    led_encoder = calloc(1, sizeof(rmt_led_strip_encoder_t));
-    ESP_GOTO_ON_FALSE(led_encoder, ESP_ERR_NO_MEM, err, TAG, "no mem for led strip encoder");
-    led_encoder->base.encode = rmt_encode_led_strip;
-    led_encoder->base.del = rmt_del_led_strip_encoder;
-    led_encoder->base.reset = rmt_led_strip_encoder_reset;
-    rmt_bytes_encoder_config_t bytes_encoder_config;
-    uint32_t reset_ticks = config->resolution / 1000000 * 280 / 2; // reset code duration defaults to 280us to accomodate WS2812B-V5
+    ESP_RETURN_ON_FALSE(config->led_model < LED_MODEL_INVALID, ESP_ERR_INVALID_ARG, TAG, "invalid led model");
+    *reset_ticks = config->resolution / 1000000 * 280 / 2; // reset code duration defaults to 280us to accomodate WS2812B-V5
     if (config->led_model == LED_MODEL_SK6812) {
-        bytes_encoder_config = (rmt_bytes_encoder_config_t) {
+        *bytes_config = (rmt_bytes_encoder_config_t) {
             .bit0 = {
                 .level0 = 1,
                 .duration0 = 0.3 * config->resolution / 1000000, // T0H=0.3us
@@ -102,7 +93,7 @@ esp_err_t rmt_new_led_strip_encoder(const led_strip_encoder_config_t *config, rm
         };
     } else if (config->led_model == LED_MODEL_WS2812) {
         // different led strip might have its own timing requirements, following parameter is for WS2812
-        bytes_encoder_config = (rmt_bytes_encoder_config_t) {
+        *bytes_config = (rmt_bytes_encoder_config_t) {
             .bit0 = {
                 .level0 = 1,
                 .duration0 = 0.3 * config->resolution / 1000000, // T0H=0.3us
@@ -119,7 +110,7 @@ esp_err_t rmt_new_led_strip_encoder(const led_strip_encoder_config_t *config, rm
         };
     } else if (config->led_model == LED_MODEL_WS2811) {
         // different led strip might have its own timing requirements, following parameter is for WS2811
-        bytes_encoder_config = (rmt_bytes_encoder_config_t) {
+        *bytes_config = (rmt_bytes_encoder_config_t) {
             .bit0 = {
                 .level0 = 1,
                 .duration0 = 0.5 * config->resolution / 1000000., // T0H=0.5us
@@ -134,10 +125,44 @@ esp_err_t rmt_new_led_strip_encoder(const led_strip_encoder_config_t *config, rm
             },
             .flags.msb_first = 1
         };
-        reset_ticks = config->resolution / 1000000 * 50 / 2; // divide by 2... signal is sent twice
+        *reset_ticks = config->resolution / 1000000 * 50 / 2; // divide by 2... signal is sent twice
     } else {
         assert(false);
     }
+    return ESP_OK;
+}
+
+esp_err_t led_strip_rmt_get_symbols(const led_strip_encoder_config_t *config, led_strip_rmt_symbols_t *ret_symbols)
+{
+    ESP_RETURN_ON_FALSE(config && ret_symbols, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    rmt_bytes_encoder_config_t bytes_encoder_config;
+    uint32_t reset_ticks = 0;
+    ESP_RETURN_ON_ERROR(led_strip_rmt_timing(config, &bytes_encoder_config, &reset_ticks), TAG, "get timing failed");
+    ret_symbols->bit0 = bytes_encoder_config.bit0;
+    ret_symbols->bit1 = bytes_encoder_config.bit1;
+    ret_symbols->reset = (rmt_symbol_word_t) {
+        .level0 = 0,
+        .duration0 = reset_ticks,
+        .level1 = 0,
+        .duration1 = reset_ticks,
+    };
+    return ESP_OK;
+}
+
+esp_err_t rmt_new_led_strip_encoder(const led_strip_encoder_config_t *config, rmt_encoder_handle_t *ret_encoder)
+{
+    esp_err_t ret = ESP_OK;
+    rmt_led_strip_encoder_t *led_encoder = NULL;
+    ESP_GOTO_ON_FALSE(config && ret_encoder, ESP_ERR_INVALID_ARG, err, TAG, "invalid argument");
+    ESP_GOTO_ON_FALSE(config->led_model < LED_MODEL_INVALID, ESP_ERR_INVALID_ARG, err, TAG, "invalid led model");
+    led_encoder = calloc(1, sizeof(rmt_led_strip_encoder_t));
+    ESP_GOTO_ON_FALSE(led_encoder, ESP_ERR_NO_MEM, err, TAG, "no mem for led strip encoder");
+    led_encoder->base.encode = rmt_encode_led_strip;
+    led_encoder->base.del = rmt_del_led_strip_encoder;
+    led_encoder->base.reset = rmt_led_strip_encoder_reset;
+    rmt_bytes_encoder_config_t bytes_encoder_config;
+    uint32_t reset_ticks = 0;
+    ESP_GOTO_ON_ERROR(led_strip_rmt_timing(config, &bytes_encoder_config, &reset_ticks), err, TAG, "get timing failed");
     ESP_GOTO_ON_ERROR(rmt_new_bytes_encoder(&bytes_encoder_config, &led_encoder->bytes_encoder), err, TAG, "create bytes encoder failed");
     rmt_copy_encoder_config_t copy_encoder_config = {};
     ESP_GOTO_ON_ERROR(rmt_new_copy_encoder(&copy_encoder_config, &led_encoder->copy_encoder), err, TAG, "create copy encoder failed");
@@ -21,6 +21,26 @@ typedef struct {
     led_model_t led_model; /*!< LED model */
 } led_strip_encoder_config_t;
 
+/**
+ * @brief RMT symbols of one LED strip bit and of the reset code
+ */
+typedef struct {
+    rmt_symbol_word_t bit0;  /*!< Symbol of a zero bit */
+    rmt_symbol_word_t bit1;  /*!< Symbol of a one bit */
+    rmt_symbol_word_t reset; /*!< Reset code sent after the pixels */
+} led_strip_rmt_symbols_t;
+
+/**
+ * @brief Get the RMT symbols used to encode LED strip pixels, MSB first
+ *
+ * @param[in] config Encoder configuration
+ * @param[out] ret_symbols Returned bit and reset symbols
+ * @return
+ *      - ESP_ERR_INVALID_ARG for any invalid arguments
+ *      - ESP_OK if the symbols were returned
+ */
+esp_err_t led_strip_rmt_get_symbols(const led_strip_encoder_config_t *config, led_strip_rmt_symbols_t *ret_symbols);
+
 /**
  * @brief Create RMT encoder for encoding LED strip pixels into RMT symbols
  *
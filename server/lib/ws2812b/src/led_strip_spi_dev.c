@@ -12,6 +12,7 @@
 #include "soc/spi_periph.h"
 #include "led_strip.h"
 #include "led_strip_interface.h"
+#include "led_strip_color_lut.h"
 
 #define LED_STRIP_SPI_DEFAULT_RESOLUTION (2.5 * 1000 * 1000) // 2.5MHz resolution
 #define LED_STRIP_SPI_DEFAULT_TRANS_QUEUE_SIZE 4
@@ -19,8 +20,22 @@
 #define SPI_BYTES_PER_COLOR_BYTE 3
 #define SPI_BITS_PER_COLOR_BYTE (SPI_BYTES_PER_COLOR_BYTE * 8)
 
+// Each color bit is sent as 3 SPI bits, low_level:100, high_level:110, MSB first
+#define SPI_CODE(d, i) ((((d) >> (i)) & 1U) ? (0x6UL << (3 * (i))) : (0x4UL << (3 * (i))))
+#define SPI_WORD(d) (SPI_CODE(d, 0) | SPI_CODE(d, 1) | SPI_CODE(d, 2) | SPI_CODE(d, 3) | \
+                     SPI_CODE(d, 4) | SPI_CODE(d, 5) | SPI_CODE(d, 6) | SPI_CODE(d, 7))
+#define SPI_LUT_1(d) {(uint8_t)(SPI_WORD(d) >> 16), (uint8_t)(SPI_WORD(d) >> 8), (uint8_t)SPI_WORD(d)}
+#define SPI_LUT_4(d) SPI_LUT_1(d), SPI_LUT_1((d) + 1), SPI_LUT_1((d) + 2), SPI_LUT_1((d) + 3)
+#define SPI_LUT_16(d) SPI_LUT_4(d), SPI_LUT_4((d) + 4), SPI_LUT_4((d) + 8), SPI_LUT_4((d) + 12)
+#define SPI_LUT_64(d) SPI_LUT_16(d), SPI_LUT_16((d) + 16), SPI_LUT_16((d) + 32), SPI_LUT_16((d) + 48)
+
 static const char *TAG = "led_strip_spi";
 
+// SPI bytes of every color byte, generated at compile time
+static const uint8_t spi_bit_lut[256][SPI_BYTES_PER_COLOR_BYTE] = {
+    SPI_LUT_64(0), SPI_LUT_64(64), SPI_LUT_64(128), SPI_LUT_64(192)
+};
+
 typedef struct {
     led_strip_t base;
     spi_host_device_t spi_host;
@@ -28,40 +43,121 @@ typedef struct {
     uint32_t strip_len;
     uint8_t bytes_per_pixel;
     led_color_component_format_t component_fmt;
-    uint8_t pixel_buf[];
+    led_strip_color_lut_t color_lut;
+    spi_transaction_t tx_conf; // owned by the SPI driver while tx_pending is set
+    bool tx_pending;
+    bool double_buffer;
+    uint8_t *pixel_buf;        // the buffer pixels are encoded into
+    uint8_t *tx_buf;           // with double buffering, the buffer handed to the DMA
+    uint32_t dirty_start;      // pixels [dirty_start, dirty_end) were encoded since the last refresh
+    uint32_t dirty_end;
+    uint8_t storage[] __attribute__((aligned(4)));
 } led_strip_spi_obj;
 
-// please make sure to zero-initialize the buf before calling this function
-static void __led_strip_spi_bit(uint8_t data, uint8_t *buf)
+static esp_err_t __led_strip_spi_wait(led_strip_spi_obj *spi_strip, TickType_t ticks_to_wait)
 {
-    // Each color of 1 bit is represented by 3 bits of SPI, low_level:100 ,high_level:110
-    // So a color byte occupies 3 bytes of SPI.
-    *(buf + 2) |= data & BIT(0) ? BIT(2) | BIT(1) : BIT(2);
-    *(buf + 2) |= data & BIT(1) ? BIT(5) | BIT(4) : BIT(5);
-    *(buf + 2) |= data & BIT(2) ? BIT(7) : 0x00;
-    *(buf + 1) |= BIT(0);
-    *(buf + 1) |= data & BIT(3) ? BIT(3) | BIT(2) : BIT(3);
-    *(buf + 1) |= data & BIT(4) ? BIT(6) | BIT(5) : BIT(6);
-    *(buf + 0) |= data & BIT(5) ? BIT(1) | BIT(0) : BIT(1);
-    *(buf + 0) |= data & BIT(6) ? BIT(4) | BIT(3) : BIT(4);
-    *(buf + 0) |= data & BIT(7) ? BIT(7) | BIT(6) : BIT(7);
+    spi_transaction_t *done = NULL;
+    if (spi_strip->tx_pending) {
+        ESP_RETURN_ON_ERROR(spi_device_get_trans_result(spi_strip->spi_device, &done, ticks_to_wait), TAG, "wait for SPI transaction failed");
+        spi_strip->tx_pending = false;
+    }
+    return ESP_OK;
+}
+
+// With a single buffer, the pixel buffer can only be written once the DMA is done with it
+static inline esp_err_t __led_strip_spi_claim(led_strip_spi_obj *spi_strip)
+{
+    if (spi_strip->tx_pending && !spi_strip->double_buffer) {
+        return __led_strip_spi_wait(spi_strip, portMAX_DELAY);
+    }
+    return ESP_OK;
+}
+
+static inline void __led_strip_spi_mark_dirty(led_strip_spi_obj *spi_strip, uint32_t start, uint32_t count)
+{
+    if (count > 0) {
+        spi_strip->dirty_start = start < spi_strip->dirty_start ? start : spi_strip->dirty_start;
+        spi_strip->dirty_end = start + count > spi_strip->dirty_end ? start + count : spi_strip->dirty_end;
+    }
+}
+
+// Overwrites the 3 SPI bytes of a color byte, no need to clear the buf first
+static inline void __led_strip_spi_bit(uint8_t data, uint8_t *buf)
+{
+    const uint8_t *spi = spi_bit_lut[data];
+    buf[0] = spi[0];
+    buf[1] = spi[1];
+    buf[2] = spi[2];
+}
+
+// Encode count pixels given as R, G, B byte triplets, starting at pixel index
+static void __led_strip_spi_encode(led_strip_spi_obj *spi_strip, uint32_t index, const uint8_t *rgb, uint32_t count)
+{
+    led_color_component_format_t component_fmt = spi_strip->component_fmt;
+    const uint32_t stride = spi_strip->bytes_per_pixel * SPI_BYTES_PER_COLOR_BYTE;
+    const uint32_t r_offset = SPI_BYTES_PER_COLOR_BYTE * component_fmt.format.r_pos;
+    const uint32_t g_offset = SPI_BYTES_PER_COLOR_BYTE * component_fmt.format.g_pos;
+    const uint32_t b_offset = SPI_BYTES_PER_COLOR_BYTE * component_fmt.format.b_pos;
+    const uint32_t w_offset = SPI_BYTES_PER_COLOR_BYTE * component_fmt.format.w_pos;
+    const uint8_t *lut = spi_strip->color_lut.lut;
+    uint8_t *buf = spi_strip->pixel_buf + index * stride;
+
+    __led_strip_spi_mark_dirty(spi_strip, index, count);
+    if (component_fmt.format.num_components > 3) {
+        for (uint32_t i = 0; i < count; i++, rgb += 3, buf += stride) {
+            __led_strip_spi_bit(lut[rgb[0]], buf + r_offset);
+            __led_strip_spi_bit(lut[rgb[1]], buf + g_offset);
+            __led_strip_spi_bit(lut[rgb[2]], buf + b_offset);
+            __led_strip_spi_bit(0, buf + w_offset);
+        }
+    } else {
+        for (uint32_t i = 0; i < count; i++, rgb += 3, buf += stride) {
+            __led_strip_spi_bit(lut[rgb[0]], buf + r_offset);
+            __led_strip_spi_bit(lut[rgb[1]], buf + g_offset);
+            __led_strip_spi_bit(lut[rgb[2]], buf + b_offset);
+        }
+    }
 }
 
 static esp_err_t led_strip_spi_set_pixel(led_strip_t *strip, uint32_t index, uint32_t red, uint32_t green, uint32_t blue)
 {
     led_strip_spi_obj *spi_strip = __containerof(strip, led_strip_spi_obj, base);
     ESP_RETURN_ON_FALSE(index < spi_strip->strip_len, ESP_ERR_INVALID_ARG, TAG, "index out of maximum number of LEDs");
+    ESP_RETURN_ON_ERROR(__led_strip_spi_claim(spi_strip), TAG, "wait for previous refresh failed");
     // 3 pixels take 72bits(9bytes)
-    uint32_t start = index * spi_strip->bytes_per_pixel * SPI_BYTES_PER_COLOR_BYTE;
-    uint8_t *pixel_buf = spi_strip->pixel_buf;
-    led_color_component_format_t component_fmt = spi_strip->component_fmt;
-    memset(pixel_buf + start, 0, spi_strip->bytes_per_pixel * SPI_BYTES_PER_COLOR_BYTE);
+    const uint8_t rgb[3] = {red, green, blue};
+    __led_strip_spi_encode(spi_strip, index, rgb, 1);
 
-    __led_strip_spi_bit(red, &pixel_buf[start + SPI_BYTES_PER_COLOR_BYTE * component_fmt.format.r_pos]);
-    __led_strip_spi_bit(green, &pixel_buf[start + SPI_BYTES_PER_COLOR_BYTE * component_fmt.format.g_pos]);
-    __led_strip_spi_bit(blue, &pixel_buf[start + SPI_BYTES_PER_COLOR_BYTE * component_fmt.format.b_pos]);
-    if (component_fmt.format.num_components > 3) {
-        __led_strip_spi_bit(0, &pixel_buf[start + SPI_BYTES_PER_COLOR_BYTE * component_fmt.format.w_pos]);
+    return ESP_OK;
+}
+
+static esp_err_t led_strip_spi_set_pixels(led_strip_t *strip, uint32_t start, uint32_t count, const uint8_t *rgb)
+{
+    led_strip_spi_obj *spi_strip = __containerof(strip, led_strip_spi_obj, base);
+    ESP_RETURN_ON_FALSE(start <= spi_strip->strip_len && count <= spi_strip->strip_len - start, ESP_ERR_INVALID_ARG, TAG, "pixels out of maximum number of LEDs");
+    ESP_RETURN_ON_ERROR(__led_strip_spi_claim(spi_strip), TAG, "wait for previous refresh failed");
+    __led_strip_spi_encode(spi_strip, start, rgb, count);
+
+    return ESP_OK;
+}
+
+static esp_err_t led_strip_spi_fill(led_strip_t *strip, uint32_t start, uint32_t count, uint32_t red, uint32_t green, uint32_t blue)
+{
+    led_strip_spi_obj *spi_strip = __containerof(strip, led_strip_spi_obj, base);
+    ESP_RETURN_ON_FALSE(start <= spi_strip->strip_len && count <= spi_strip->strip_len - start, ESP_ERR_INVALID_ARG, TAG, "pixels out of maximum number of LEDs");
+    ESP_RETURN_ON_ERROR(__led_strip_spi_claim(spi_strip), TAG, "wait for previous refresh failed");
+
+    if (count > 0) {
+        const uint8_t rgb[3] = {red, green, blue};
+        const uint32_t stride = spi_strip->bytes_per_pixel * SPI_BYTES_PER_COLOR_BYTE;
+        uint8_t *buf = spi_strip->pixel_buf + start * stride;
+        // encode the first pixel, then keep doubling the encoded part of the run
+        __led_strip_spi_encode(spi_strip, start, rgb, 1);
+        for (uint32_t done = 1; done < count; done *= 2) {
+            uint32_t copy = (count - done < done) ? count - done : done;
+            memcpy(buf + done * stride, buf, copy * stride);
+        }
+        __led_strip_spi_mark_dirty(spi_strip, start, count);
     }
 
     return ESP_OK;
@@ -73,44 +169,91 @@ static esp_err_t led_strip_spi_set_pixel_rgbw(led_strip_t *strip, uint32_t index
     led_color_component_format_t component_fmt = spi_strip->component_fmt;
     ESP_RETURN_ON_FALSE(index < spi_strip->strip_len, ESP_ERR_INVALID_ARG, TAG, "index out of maximum number of LEDs");
     ESP_RETURN_ON_FALSE(component_fmt.format.num_components == 4, ESP_ERR_INVALID_ARG, TAG, "led doesn't have 4 components");
+    ESP_RETURN_ON_ERROR(__led_strip_spi_claim(spi_strip), TAG, "wait for previous refresh failed");
 
     // LED_PIXEL_FORMAT_GRBW takes 96bits(12bytes)
     uint32_t start = index * spi_strip->bytes_per_pixel * SPI_BYTES_PER_COLOR_BYTE;
     uint8_t *pixel_buf = spi_strip->pixel_buf;
-    memset(pixel_buf + start, 0, spi_strip->bytes_per_pixel * SPI_BYTES_PER_COLOR_BYTE);
+    const uint8_t *lut = spi_strip->color_lut.lut;
 
-    __led_strip_spi_bit(red, &pixel_buf[start + SPI_BYTES_PER_COLOR_BYTE * component_fmt.format.r_pos]);
-    __led_strip_spi_bit(green, &pixel_buf[start + SPI_BYTES_PER_COLOR_BYTE * component_fmt.format.g_pos]);
-    __led_strip_spi_bit(blue, &pixel_buf[start + SPI_BYTES_PER_COLOR_BYTE * component_fmt.format.b_pos]);
-    __led_strip_spi_bit(white, &pixel_buf[start + SPI_BYTES_PER_COLOR_BYTE * component_fmt.format.w_pos]);
+    __led_strip_spi_bit(lut[red & 0xFF], &pixel_buf[start + SPI_BYTES_PER_COLOR_BYTE * component_fmt.format.r_pos]);
+    __led_strip_spi_bit(lut[green & 0xFF], &pixel_buf[start + SPI_BYTES_PER_COLOR_BYTE * component_fmt.format.g_pos]);
+    __led_strip_spi_bit(lut[blue & 0xFF], &pixel_buf[start + SPI_BYTES_PER_COLOR_BYTE * component_fmt.format.b_pos]);
+    __led_strip_spi_bit(lut[white & 0xFF], &pixel_buf[start + SPI_BYTES_PER_COLOR_BYTE * component_fmt.format.w_pos]);
+    __led_strip_spi_mark_dirty(spi_strip, index, 1);
 
     return ESP_OK;
 }
 
-static esp_err_t led_strip_spi_refresh(led_strip_t *strip)
+static esp_err_t led_strip_spi_set_gamma(led_strip_t *strip, float gamma)
+{
+    led_strip_spi_obj *spi_strip = __containerof(strip, led_strip_spi_obj, base);
+    ESP_RETURN_ON_ERROR(led_strip_color_lut_set_gamma(&spi_strip->color_lut, gamma), TAG, "invalid gamma");
+    return ESP_OK;
+}
+
+static esp_err_t led_strip_spi_set_brightness(led_strip_t *strip, uint8_t brightness)
 {
     led_strip_spi_obj *spi_strip = __containerof(strip, led_strip_spi_obj, base);
-    spi_transaction_t tx_conf;
-    memset(&tx_conf, 0, sizeof(tx_conf));
+    led_strip_color_lut_set_brightness(&spi_strip->color_lut, brightness);
+    return ESP_OK;
+}
+
+static esp_err_t led_strip_spi_refresh_async(led_strip_t *strip)
+{
+    led_strip_spi_obj *spi_strip = __containerof(strip, led_strip_spi_obj, base);
+    // only one frame is on the wire at a time
+    ESP_RETURN_ON_ERROR(__led_strip_spi_wait(spi_strip, portMAX_DELAY), TAG, "wait for previous refresh failed");
+
+    memset(&spi_strip->tx_conf, 0, sizeof(spi_strip->tx_conf));
+    spi_strip->tx_conf.length = spi_strip->strip_len * spi_strip->bytes_per_pixel * SPI_BITS_PER_COLOR_BYTE;
+    spi_strip->tx_conf.tx_buffer = spi_strip->pixel_buf;
+    spi_strip->tx_conf.rx_buffer = NULL;
+    ESP_RETURN_ON_ERROR(spi_device_queue_trans(spi_strip->spi_device, &spi_strip->tx_conf, portMAX_DELAY), TAG, "queue pixels to SPI failed");
+    spi_strip->tx_pending = true;
 
-    tx_conf.length = spi_strip->strip_len * spi_strip->bytes_per_pixel * SPI_BITS_PER_COLOR_BYTE;
-    tx_conf.tx_buffer = spi_strip->pixel_buf;
-    tx_conf.rx_buffer = NULL;
-    ESP_RETURN_ON_ERROR(spi_device_transmit(spi_strip->spi_device, &tx_conf), TAG, "transmit pixels by SPI failed");
+    if (spi_strip->double_buffer) {
+        // keep encoding into the other buffer, which holds the previous frame,
+        // so only the pixels encoded since then have to be brought up to date
+        uint8_t *sent = spi_strip->pixel_buf;
+        spi_strip->pixel_buf = spi_strip->tx_buf;
+        spi_strip->tx_buf = sent;
+        if (spi_strip->dirty_start < spi_strip->dirty_end) {
+            const uint32_t stride = spi_strip->bytes_per_pixel * SPI_BYTES_PER_COLOR_BYTE;
+            const uint32_t offset = spi_strip->dirty_start * stride;
+            memcpy(spi_strip->pixel_buf + offset, sent + offset, (spi_strip->dirty_end - spi_strip->dirty_start) * stride);
+        }
+    }
+    spi_strip->dirty_start = spi_strip->strip_len;
+    spi_strip->dirty_end = 0;
 
     return ESP_OK;
 }
 
+static esp_err_t led_strip_spi_wait_refresh_done(led_strip_t *strip, int timeout_ms)
+{
+    led_strip_spi_obj *spi_strip = __containerof(strip, led_strip_spi_obj, base);
+    TickType_t ticks_to_wait = timeout_ms < 0 ? portMAX_DELAY : pdMS_TO_TICKS(timeout_ms);
+    return __led_strip_spi_wait(spi_strip, ticks_to_wait);
+}
+
+static esp_err_t led_strip_spi_refresh(led_strip_t *strip)
+{
+    ESP_RETURN_ON_ERROR(led_strip_spi_refresh_async(strip), TAG, "transmit pixels by SPI failed");
+    return led_strip_spi_wait_refresh_done(strip, -1);
+}
+
 static esp_err_t led_strip_spi_clear(led_strip_t *strip)
 {
     led_strip_spi_obj *spi_strip = __containerof(strip, led_strip_spi_obj, base);
+    ESP_RETURN_ON_ERROR(__led_strip_spi_claim(spi_strip), TAG, "wait for previous refresh failed");
     //Write zero to turn off all leds
-    memset(spi_strip->pixel_buf, 0, spi_strip->strip_len * spi_strip->bytes_per_pixel * SPI_BYTES_PER_COLOR_BYTE);
     uint8_t *buf = spi_strip->pixel_buf;
     for (int index = 0; index < spi_strip->strip_len * spi_strip->bytes_per_pixel; index++) {
         __led_strip_spi_bit(0, buf);
         buf += SPI_BYTES_PER_COLOR_BYTE;
     }
+    __led_strip_spi_mark_dirty(spi_strip, 0, spi_strip->strip_len);
 
     return led_strip_spi_refresh(strip);
 }
@@ -119,6 +262,7 @@ static esp_err_t led_strip_spi_del(led_strip_t *strip)
 {
     led_strip_spi_obj *spi_strip = __containerof(strip, led_strip_spi_obj, base);
 
+    ESP_RETURN_ON_ERROR(__led_strip_spi_wait(spi_strip, portMAX_DELAY), TAG, "wait for previous refresh failed");
     ESP_RETURN_ON_ERROR(spi_bus_remove_device(spi_strip->spi_device), TAG, "delete spi device failed");
     ESP_RETURN_ON_ERROR(spi_bus_free(spi_strip->spi_host), TAG, "free spi bus failed");
 
@@ -131,6 +275,7 @@ esp_err_t led_strip_new_spi_device(const led_strip_config_t *led_config, const l
     led_strip_spi_obj *spi_strip = NULL;
     esp_err_t ret = ESP_OK;
     ESP_GOTO_ON_FALSE(led_config && spi_config && ret_strip, ESP_ERR_INVALID_ARG, err, TAG, "invalid argument");
+    ESP_GOTO_ON_FALSE(!spi_config->flags.double_buffer || spi_config->flags.with_dma, ESP_ERR_INVALID_ARG, err, TAG, "double buffer requires DMA");
     led_color_component_format_t component_fmt = led_config->color_component_format;
     // If R/G/B order is not specified, set default GRB order as fallback
     if (component_fmt.format_id == 0) {
@@ -156,9 +301,16 @@ esp_err_t led_strip_new_spi_device(const led_strip_config_t *led_config, const l
         // DMA buffer must be placed in internal SRAM
         mem_caps |= MALLOC_CAP_INTERNAL | MALLOC_CAP_DMA;
     }
-    spi_strip = heap_caps_calloc(1, sizeof(led_strip_spi_obj) + led_config->max_leds * bytes_per_pixel * SPI_BYTES_PER_COLOR_BYTE, mem_caps);
+    // the second buffer starts on a word boundary, as the first one does
+    uint32_t buf_size = led_config->max_leds * bytes_per_pixel * SPI_BYTES_PER_COLOR_BYTE;
+    uint32_t buf_stride = (buf_size + 3) & ~3U;
+    uint32_t num_bufs = spi_config->flags.double_buffer ? 2 : 1;
+    spi_strip = heap_caps_calloc(1, sizeof(led_strip_spi_obj) + num_bufs * buf_stride, mem_caps);
 
     ESP_GOTO_ON_FALSE(spi_strip, ESP_ERR_NO_MEM, err, TAG, "no mem for spi strip");
+    spi_strip->double_buffer = spi_config->flags.double_buffer;
+    spi_strip->pixel_buf = spi_strip->storage;
+    spi_strip->tx_buf = spi_strip->double_buffer ? spi_strip->storage + buf_stride : NULL;
 
     spi_strip->spi_host = spi_config->spi_bus;
     // for backward compatibility, if the user does not set the clk_src, use the default value
@@ -206,11 +358,19 @@ esp_err_t led_strip_new_spi_device(const led_strip_config_t *led_config, const l
                       TAG, "unsupported clock resolution:%dKHz", clock_resolution_khz);
 
     spi_strip->component_fmt = component_fmt;
+    led_strip_color_lut_init(&spi_strip->color_lut);
     spi_strip->bytes_per_pixel = bytes_per_pixel;
     spi_strip->strip_len = led_config->max_leds;
+    spi_strip->dirty_start = spi_strip->strip_len;
     spi_strip->base.set_pixel = led_strip_spi_set_pixel;
     spi_strip->base.set_pixel_rgbw = led_strip_spi_set_pixel_rgbw;
+    spi_strip->base.set_pixels = led_strip_spi_set_pixels;
+    spi_strip->base.fill = led_strip_spi_fill;
     spi_strip->base.refresh = led_strip_spi_refresh;
+    spi_strip->base.set_gamma = led_strip_spi_set_gamma;
+    spi_strip->base.set_brightness = led_strip_spi_set_brightness;
+    spi_strip->base.refresh_async = led_strip_spi_refresh_async;
+    spi_strip->base.wait_refresh_done = led_strip_spi_wait_refresh_done;
     spi_strip->base.clear = led_strip_spi_clear;
     spi_strip->base.del = led_strip_spi_del;
 
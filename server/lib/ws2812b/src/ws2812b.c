@@ -1,31 +1,112 @@
+#include <string.h>
 #include "ws2812b.h"
 #include "esp_check.h"
 #include "led_strip.h"
 #include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+
+#define BYTES_PER_PIXEL 3
+
+static void refresh(void *param);
+static void frame_changed(uint32_t start, uint32_t count);
+static TickType_t ms_to_period(uint32_t period_ms);
 
 static led_strip_handle_t led_strip;
-static volatile uint8_t red, green, blue;
+static TaskHandle_t refresh_task;
+static SemaphoreHandle_t frame_lock;
+static uint8_t frame[WS2812B_MAX_LEDS * BYTES_PER_PIXEL];
+static uint32_t led_count;
+static uint32_t dirty_start; // frame pixels [dirty_start, dirty_end) have to be encoded into the strip
+static uint32_t dirty_end;
+static bool encoded = false; // strip was filled directly and has to be refreshed
+static TickType_t refresh_period;
+static ws2812b_effect_t effect;
+static TickType_t effect_start;
 
 static void refresh(void *param)
 {
     (void)param;
 
+    TickType_t last_wake = xTaskGetTickCount();
+
     while (1)
     {
-        ESP_ERROR_CHECK(led_strip_set_pixel(led_strip, 0, red, green, blue));
-        ESP_ERROR_CHECK(led_strip_refresh(led_strip));
-        vTaskDelay(pdMS_TO_TICKS(10));
+        bool redraw = false;
+        TickType_t period = 0;
+
+        (void)xSemaphoreTakeRecursive(frame_lock, portMAX_DELAY);
+        if (WS2812B_EFFECT_NONE != effect.type)
+        {
+            uint32_t elapsed_ms = (xTaskGetTickCount() - effect_start) * portTICK_PERIOD_MS;
+            ws2812b_effect_render(&effect, elapsed_ms, frame, led_count);
+            dirty_start = 0;
+            dirty_end = led_count;
+            period = ms_to_period((0 == effect.frame_ms) ? WS2812B_EFFECT_FRAME_MS : effect.frame_ms);
+        }
+        else
+        {
+            period = refresh_period;
+        }
+        if (dirty_start < dirty_end)
+        {
+            ESP_ERROR_CHECK(led_strip_set_pixels(led_strip, dirty_start, dirty_end - dirty_start, &frame[dirty_start * BYTES_PER_PIXEL]));
+            dirty_start = led_count;
+            dirty_end = 0;
+            redraw = true;
+        }
+        redraw = encoded || redraw;
+        encoded = false;
+
+        // Direct fills write the strip buffer, so it is only handed over under the lock
+        if (redraw || (0 != period))
+        {
+            ESP_ERROR_CHECK(led_strip_refresh_async(led_strip));
+        }
+        (void)xSemaphoreGiveRecursive(frame_lock);
+
+        if (0 == period)
+        {
+            // Sleep until the frame changes or a fixed rate is requested
+            (void)ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+            last_wake = xTaskGetTickCount();
+        }
+        else
+        {
+            vTaskDelayUntil(&last_wake, period);
+        }
     }
 }
 
-bool ws2812b_init(void)
+// Must be called with frame_lock held
+static void frame_changed(uint32_t start, uint32_t count)
+{
+    dirty_start = (start < dirty_start) ? start : dirty_start;
+    dirty_end = (start + count > dirty_end) ? start + count : dirty_end;
+    (void)xTaskNotifyGive(refresh_task);
+}
+
+static TickType_t ms_to_period(uint32_t period_ms)
+{
+    TickType_t period = 0;
+
+    if (0 != period_ms)
+    {
+        period = pdMS_TO_TICKS(period_ms);
+        period = (0 == period) ? 1 : period;
+    }
+
+    return period;
+}
+
+bool ws2812b_init(int gpio, uint32_t count)
 {
     bool status = false;
 
     // LED strip general initialization, according to your led board design
     led_strip_config_t strip_config = {
-        .strip_gpio_num = GPIO_NUM_8,  // The GPIO that connected to the LED strip's data line
-        .max_leds = 1,                 // The number of LEDs in the strip,
+        .strip_gpio_num = gpio,        // The GPIO that connected to the LED strip's data line
+        .max_leds = count,             // The number of LEDs in the strip,
         .led_model = LED_MODEL_WS2812, // LED strip model
         // set the color order of the strip: GRB
         .color_component_format = {
@@ -45,20 +126,151 @@ bool ws2812b_init(void)
         .clk_src = SPI_CLK_SRC_DEFAULT, // different clock source can lead to different power consumption
         .spi_bus = SPI2_HOST,           // SPI bus ID
         .flags = {
-            .with_dma = false, // Using DMA can improve performance and help drive more LEDs
+            .with_dma = true,      // Using DMA can improve performance and help drive more LEDs
+            .double_buffer = true, // Encode the next frame while DMA sends the current one
         }};
 
-    if (ESP_OK == led_strip_new_spi_device(&strip_config, &spi_config, &led_strip))
+    if ((0 < count) && (count <= WS2812B_MAX_LEDS))
     {
-        status = (pdTRUE == xTaskCreate(refresh, "", 2048, NULL, 0, NULL));
+        led_count = count;
+        // the whole frame is encoded on the first refresh
+        dirty_start = 0;
+        dirty_end = count;
+        frame_lock = xSemaphoreCreateRecursiveMutex();
+
+        if ((NULL != frame_lock) && (ESP_OK == led_strip_new_spi_device(&strip_config, &spi_config, &led_strip)))
+        {
+            status = (pdTRUE == xTaskCreate(refresh, "", 2048, NULL, 0, &refresh_task));
+        }
     }
 
     return status;
 }
 
+uint32_t ws2812b_led_count(void)
+{
+    return led_count;
+}
+
 void ws2812b_set_color(uint8_t _red, uint8_t _green, uint8_t _blue)
 {
-    red = _red;
-    green = _green;
-    blue = _blue;
-}
\ No newline at end of file
+    bool changed = false;
+
+    (void)xSemaphoreTakeRecursive(frame_lock, portMAX_DELAY);
+
+    effect.type = WS2812B_EFFECT_NONE;
+
+    for (uint32_t i = 0; i < led_count * BYTES_PER_PIXEL; i += BYTES_PER_PIXEL)
+    {
+        changed |= (frame[i] != _red) || (frame[i + 1] != _green) || (frame[i + 2] != _blue);
+        frame[i] = _red;
+        frame[i + 1] = _green;
+        frame[i + 2] = _blue;
+    }
+
+    if (changed)
+    {
+        frame_changed(0, led_count);
+    }
+
+    (void)xSemaphoreGiveRecursive(frame_lock);
+}
+
+bool ws2812b_set_pixels(uint32_t start, uint32_t count, const uint8_t *rgb)
+{
+    bool status = false;
+
+    if ((start <= led_count) && (count <= led_count - start) && ((NULL != rgb) || (0 == count)))
+    {
+        uint8_t *pixels = &frame[start * BYTES_PER_PIXEL];
+
+        (void)xSemaphoreTakeRecursive(frame_lock, portMAX_DELAY);
+        effect.type = WS2812B_EFFECT_NONE;
+        if (0 != memcmp(pixels, rgb, count * BYTES_PER_PIXEL))
+        {
+            memcpy(pixels, rgb, count * BYTES_PER_PIXEL);
+            frame_changed(start, count);
+        }
+        (void)xSemaphoreGiveRecursive(frame_lock);
+        status = true;
+    }
+
+    return status;
+}
+
+void ws2812b_set_frame(const uint8_t *rgb)
+{
+    (void)ws2812b_set_pixels(0, led_count, rgb);
+}
+
+void ws2812b_set_effect(const ws2812b_effect_t *_effect)
+{
+    (void)xSemaphoreTakeRecursive(frame_lock, portMAX_DELAY);
+    effect = *_effect;
+    effect_start = xTaskGetTickCount();
+    (void)xTaskNotifyGive(refresh_task);
+    (void)xSemaphoreGiveRecursive(frame_lock);
+}
+
+void ws2812b_set_refresh_period(uint32_t period_ms)
+{
+    (void)xSemaphoreTakeRecursive(frame_lock, portMAX_DELAY);
+    refresh_period = ms_to_period(period_ms);
+    (void)xTaskNotifyGive(refresh_task);
+    (void)xSemaphoreGiveRecursive(frame_lock);
+}
+
+bool ws2812b_fill(uint32_t start, uint32_t count, const uint8_t *rgb)
+{
+    bool status = false;
+
+    if ((start <= led_count) && (count <= led_count - start) && (NULL != rgb))
+    {
+        (void)xSemaphoreTakeRecursive(frame_lock, portMAX_DELAY);
+        effect.type = WS2812B_EFFECT_NONE;
+
+        // Keep the frame in step with the strip, which is encoded once per run
+        for (uint32_t i = start * BYTES_PER_PIXEL; i < (start + count) * BYTES_PER_PIXEL; i += BYTES_PER_PIXEL)
+        {
+            frame[i] = rgb[0];
+            frame[i + 1] = rgb[1];
+            frame[i + 2] = rgb[2];
+        }
+
+        status = (ESP_OK == led_strip_fill(led_strip, start, count, rgb[0], rgb[1], rgb[2]));
+        encoded = true;
+        (void)xTaskNotifyGive(refresh_task);
+        (void)xSemaphoreGiveRecursive(frame_lock);
+    }
+
+    return status;
+}
+
+void ws2812b_begin_update(void)
+{
+    (void)xSemaphoreTakeRecursive(frame_lock, portMAX_DELAY);
+}
+
+void ws2812b_end_update(void)
+{
+    (void)xSemaphoreGiveRecursive(frame_lock);
+}
+
+bool ws2812b_set_gamma(float gamma)
+{
+    (void)xSemaphoreTakeRecursive(frame_lock, portMAX_DELAY);
+    bool status = (ESP_OK == led_strip_set_gamma(led_strip, gamma));
+    // The correction is applied while encoding, so the frame is encoded again
+    frame_changed(0, led_count);
+    (void)xSemaphoreGiveRecursive(frame_lock);
+
+    return status;
+}
+
+void ws2812b_set_brightness(uint8_t brightness)
+{
+    (void)xSemaphoreTakeRecursive(frame_lock, portMAX_DELAY);
+    (void)led_strip_set_brightness(led_strip, brightness);
+    frame_changed(0, led_count);
+    (void)xSemaphoreGiveRecursive(frame_lock);
+}
@@ -0,0 +1,88 @@
+#include "ws2812b_effect.h"
+
+#define WEIGHT_ONE 256U // weights are Q8, WEIGHT_ONE selects the second colour only
+
+static uint32_t cycle_phase(const ws2812b_effect_t *effect, uint32_t elapsed_ms);
+static uint32_t triangle(uint32_t phase);
+static void blend(const uint8_t *from, const uint8_t *to, uint32_t weight, uint8_t *rgb);
+static void fill(const uint8_t *color, uint8_t *rgb, uint32_t led_count);
+
+// Position within the current cycle, 0 to 2 * WEIGHT_ONE - 1
+static uint32_t cycle_phase(const ws2812b_effect_t *effect, uint32_t elapsed_ms)
+{
+    uint32_t period = (0 == effect->period_ms) ? 1 : effect->period_ms;
+
+    return ((elapsed_ms % period) * (2 * WEIGHT_ONE)) / period;
+}
+
+// Rises from 0 to WEIGHT_ONE over the first half of the cycle and falls back over the second
+static uint32_t triangle(uint32_t phase)
+{
+    phase &= (2 * WEIGHT_ONE) - 1;
+
+    return (phase <= WEIGHT_ONE) ? phase : ((2 * WEIGHT_ONE) - phase);
+}
+
+static void blend(const uint8_t *from, const uint8_t *to, uint32_t weight, uint8_t *rgb)
+{
+    for (uint32_t i = 0; i < 3; i++)
+    {
+        rgb[i] = (uint8_t)((from[i] * (WEIGHT_ONE - weight) + to[i] * weight) >> 8);
+    }
+}
+
+static void fill(const uint8_t *color, uint8_t *rgb, uint32_t led_count)
+{
+    for (uint32_t i = 0; i < led_count; i++, rgb += 3)
+    {
+        rgb[0] = color[0];
+        rgb[1] = color[1];
+        rgb[2] = color[2];
+    }
+}
+
+void ws2812b_effect_render(const ws2812b_effect_t *effect, uint32_t elapsed_ms, uint8_t *rgb, uint32_t led_count)
+{
+    uint32_t phase = cycle_phase(effect, elapsed_ms);
+    uint8_t color[3];
+
+    switch (effect->type)
+    {
+    case WS2812B_EFFECT_FADE:
+        blend(effect->from, effect->to, triangle(phase), color);
+        fill(color, rgb, led_count);
+        break;
+
+    case WS2812B_EFFECT_BLINK:
+        fill((phase < WEIGHT_ONE) ? effect->from : effect->to, rgb, led_count);
+        break;
+
+    case WS2812B_EFFECT_CHASE:
+    {
+        // Head position in Q8 LEDs, the fraction is split between two neighbours
+        uint32_t position = (phase * led_count) >> 1;
+        uint32_t head = (position >> 8) % (0 == led_count ? 1 : led_count);
+        uint32_t fraction = position & 0xFF;
+
+        fill(effect->from, rgb, led_count);
+        if (0 < led_count)
+        {
+            blend(effect->from, effect->to, WEIGHT_ONE - fraction, &rgb[head * 3]);
+            blend(effect->from, effect->to, fraction, &rgb[((head + 1) % led_count) * 3]);
+        }
+        break;
+    }
+
+    case WS2812B_EFFECT_GRADIENT:
+        for (uint32_t i = 0; i < led_count; i++)
+        {
+            // One full from -> to -> from cycle spans the strip
+            uint32_t offset = (i * 2 * WEIGHT_ONE) / led_count;
+            blend(effect->from, effect->to, triangle(phase + offset), &rgb[i * 3]);
+        }
+        break;
+
+    default:
+        break;
+    }
+}
@@ -1,6 +1,8 @@
 #include <stdio.h>
 #include "ws2812b.h"
 #include "session.h"
+#include "telemetry.h"
+#include "sampler.h"
 #include "driver/temperature_sensor.h"
 #include "driver/gpio.h"
 
@@ -11,6 +13,20 @@
 #define LED_ON 1
 #define LED_OFF 0
 
+// The on-board LED of the DevKitC, pass both as build flags for an external strip
+#ifndef RGB_LED_GPIO
+#define RGB_LED_GPIO GPIO_NUM_8
+#endif
+
+#ifndef RGB_LED_COUNT
+#define RGB_LED_COUNT 1
+#endif
+
+// USB-Serial-JTAG is a much faster link than the UART at 2 Mbaud
+#ifndef SESSION_TRANSPORT
+#define SESSION_TRANSPORT transport_uart
+#endif
+
 #define RGB_LED_COLOR_BLUE 0, 0, 255
 #define RGB_LED_COLOR_GREEN 0, 255, 0
 #define RGB_LED_COLOR_RED 255, 0, 0
@@ -21,10 +37,14 @@ static bool init_led(void);
 static bool init_temp(void);
 static bool toggle_led(void);
 static bool read_temperature(float *temperature);
+static bool handle_batch(void);
+static bool handle_subscribe(void);
+static bool handle_set_pixels(void);
 
 void app_main(void)
 {
-    bool status = init_led() && init_temp() && session_init() && ws2812b_init();
+    bool status = init_led() && init_temp() && session_init(&SESSION_TRANSPORT, SPEED) && ws2812b_init(RGB_LED_GPIO, RGB_LED_COUNT) &&
+                  telemetry_init(read_temperature) && sampler_init(read_temperature);
 
     if (!status)
     {
@@ -33,6 +53,7 @@ void app_main(void)
         }
     }
     ws2812b_set_color(RGB_LED_COLOR_GREEN);
+    bool shown_status = true;
 
     while (true)
     {
@@ -41,6 +62,7 @@ void app_main(void)
             if (!session_establish())
             {
                 ws2812b_set_color(RGB_LED_COLOR_RED);
+                shown_status = false;
             }
         }
 
@@ -59,6 +81,27 @@ void app_main(void)
                 session_send_toggle_led(status, gpio_get_level(LED_GPIO));
                 break;
 
+            case BATCH:
+                status = handle_batch();
+                break;
+
+            case SUBSCRIBE_TEMP:
+                status = handle_subscribe();
+                break;
+
+            case UNSUBSCRIBE_TEMP:
+                telemetry_unsubscribe();
+                status = session_send_status(true);
+                break;
+
+            case DUMP_SAMPLES:
+                status = sampler_dump(session_send_samples, SESSION_SAMPLES_MAX_CHUNK);
+                break;
+
+            case SET_PIXELS:
+                status = handle_set_pixels();
+                break;
+
             case INVALID:
                 break;
 
@@ -66,13 +109,18 @@ void app_main(void)
                 break;
             }
 
-            if (!status)
-            {
-                ws2812b_set_color(RGB_LED_COLOR_RED);
-            }
-            else
+            // Only a change of status is shown, so a frame set by SET_PIXELS stays up
+            if (status != shown_status)
             {
-                ws2812b_set_color(RGB_LED_COLOR_GREEN);
+                if (!status)
+                {
+                    ws2812b_set_color(RGB_LED_COLOR_RED);
+                }
+                else
+                {
+                    ws2812b_set_color(RGB_LED_COLOR_GREEN);
+                }
+                shown_status = status;
             }
         }
     }
@@ -122,8 +170,57 @@ static bool read_temperature(float *temperature)
     return (ESP_OK == temperature_sensor_get_celsius(temp_handle, temperature));
 }
 
-static bool toggle_led(void)
+static bool handle_batch(void)
 {
+    session_request_t commands[SESSION_BATCH_MAX_COMMANDS];
+    session_batch_result_t results[SESSION_BATCH_MAX_COMMANDS] = {0};
+    bool status = true;
+
+    size_t count = session_get_batch(commands, SESSION_BATCH_MAX_COMMANDS);
 
+    for (size_t i = 0; i < count; i++)
+    {
+        results[i].request = commands[i];
+
+        if (commands[i] == GET_TEMP)
+        {
+            results[i].status = read_temperature(&results[i].temperature);
+        }
+        else if (commands[i] == TOGGLE_LED)
+        {
+            results[i].status = toggle_led();
+            results[i].led_state = gpio_get_level(LED_GPIO);
+        }
+
+        status = status && results[i].status;
+    }
+
+    return session_send_batch(results, count) && status;
+}
+
+static bool handle_subscribe(void)
+{
+    uint16_t interval_ms = 0;
+    uint16_t threshold_centi = 0;
+
+    bool status = session_get_subscription(&interval_ms, &threshold_centi) &&
+                  telemetry_subscribe(interval_ms, threshold_centi);
+
+    return session_send_status(status) && status;
+}
+
+static bool toggle_led(void)
+{
     return (ESP_OK == gpio_set_level(LED_GPIO, !gpio_get_level(LED_GPIO)));
-}
\ No newline at end of file
+}
+
+static bool handle_set_pixels(void)
+{
+    // The whole frame is decoded before the strip is refreshed
+    ws2812b_begin_update();
+    bool status = session_get_pixels(ws2812b_led_count(), ws2812b_fill);
+    ws2812b_end_update();
+
+    // A refused frame is the client's error, the strip keeps what it shows
+    return session_send_status(status);
+}
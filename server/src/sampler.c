@@ -0,0 +1,214 @@
+#include <math.h>
+#include <string.h>
+#include <sys/time.h>
+#include "sampler.h"
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+
+#define SAMPLER_STACK_SIZE 4096
+#define SAMPLER_PRIORITY 4
+
+/* Size in bytes */
+#define TIME_SIZE 8
+#define TEMP_SIZE 2
+#define BLOCK_HEADER_SIZE (TIME_SIZE + TEMP_SIZE)
+#define LENGTH_PREFIX_SIZE 1
+#define VARINT_MAX_SIZE 5
+#define RECORD_MAX_SIZE (2 * VARINT_MAX_SIZE)
+
+#define CENTI_PER_DEGREE 100.0f
+#define VARINT_MASK 0x7F
+#define VARINT_MORE 0x80
+#define VARINT_SHIFT 7
+
+typedef struct
+{
+    uint8_t data[SAMPLER_BLOCK_SIZE];
+    uint8_t used;
+} sampler_block_t;
+
+static sampler_block_t ring[SAMPLER_BLOCK_COUNT];
+static size_t head = 0;  // block being appended to
+static size_t count = 0; // blocks in use, including head
+static uint64_t last_time_ms = 0;
+static int16_t last_temp = 0;
+
+static SemaphoreHandle_t ring_lock = NULL;
+static sampler_read_t read_sensor = NULL;
+static uint8_t chunk_buf[SAMPLER_CHUNK_MAX];
+
+static void sampler_task(void *arg);
+static void append(uint64_t time_ms, int16_t temp);
+static void start_block(uint64_t time_ms, int16_t temp);
+static size_t write_varint(uint8_t *buf, uint32_t v);
+static inline uint32_t zigzag(int32_t v);
+static uint64_t now_ms(void);
+
+bool sampler_init(sampler_read_t read_temperature)
+{
+    bool status = false;
+    read_sensor = read_temperature;
+
+    ring_lock = xSemaphoreCreateMutex();
+
+    if (ring_lock != NULL)
+    {
+        status = (pdPASS == xTaskCreate(sampler_task, "sampler", SAMPLER_STACK_SIZE,
+                                        NULL, SAMPLER_PRIORITY, NULL));
+    }
+
+    return status;
+}
+
+bool sampler_dump(sampler_chunk_t chunk, size_t chunk_size)
+{
+    bool status = true;
+
+    if (chunk_size > sizeof(chunk_buf))
+    {
+        chunk_size = sizeof(chunk_buf);
+    }
+
+    xSemaphoreTake(ring_lock, portMAX_DELAY);
+
+    size_t oldest = (head + SAMPLER_BLOCK_COUNT - (count > 0 ? count - 1 : 0)) % SAMPLER_BLOCK_COUNT;
+
+    // First pass only counts the chunks, the header of every chunk carries the total
+    uint16_t chunks = 1;
+    size_t len = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        size_t block_len = LENGTH_PREFIX_SIZE + ring[(oldest + i) % SAMPLER_BLOCK_COUNT].used;
+        if (len + block_len > chunk_size)
+        {
+            chunks++;
+            len = 0;
+        }
+        len += block_len;
+    }
+
+    uint16_t index = 0;
+    len = 0;
+    for (size_t i = 0; status && (i < count); i++)
+    {
+        const sampler_block_t *block = &ring[(oldest + i) % SAMPLER_BLOCK_COUNT];
+
+        if (len + LENGTH_PREFIX_SIZE + block->used > chunk_size)
+        {
+            status = chunk(index++, chunks, chunk_buf, len);
+            len = 0;
+        }
+
+        chunk_buf[len] = block->used;
+        memcpy(chunk_buf + len + LENGTH_PREFIX_SIZE, block->data, block->used);
+        len += LENGTH_PREFIX_SIZE + block->used;
+    }
+
+    if (status)
+    {
+        status = chunk(index, chunks, chunk_buf, len);
+    }
+
+    xSemaphoreGive(ring_lock);
+
+    return status;
+}
+
+static void sampler_task(void *arg)
+{
+    (void)arg;
+
+    TickType_t next_sample = xTaskGetTickCount();
+
+    while (true)
+    {
+        float temperature = 0.0f;
+
+        if (read_sensor(&temperature))
+        {
+            int16_t temp = (int16_t)lroundf(temperature * CENTI_PER_DEGREE);
+
+            xSemaphoreTake(ring_lock, portMAX_DELAY);
+            append(now_ms(), temp);
+            xSemaphoreGive(ring_lock);
+        }
+
+        next_sample += pdMS_TO_TICKS(SAMPLER_INTERVAL_MS);
+        TickType_t now = xTaskGetTickCount();
+        vTaskDelay(((int32_t)(next_sample - now) > 0) ? (next_sample - now) : 0);
+    }
+}
+
+static void append(uint64_t time_ms, int16_t temp)
+{
+    sampler_block_t *block = &ring[head];
+
+    // A clock step (e.g. when the session sets the RTC) starts a new block
+    if ((count == 0) ||
+        (block->used + RECORD_MAX_SIZE > SAMPLER_BLOCK_SIZE) ||
+        (time_ms < last_time_ms) ||
+        (time_ms - last_time_ms > UINT32_MAX))
+    {
+        start_block(time_ms, temp);
+    }
+    else
+    {
+        block->used += write_varint(block->data + block->used, (uint32_t)(time_ms - last_time_ms));
+        block->used += write_varint(block->data + block->used, zigzag((int32_t)temp - last_temp));
+    }
+
+    last_time_ms = time_ms;
+    last_temp = temp;
+}
+
+static void start_block(uint64_t time_ms, int16_t temp)
+{
+    if (count > 0)
+    {
+        head = (head + 1) % SAMPLER_BLOCK_COUNT;
+    }
+    if (count < SAMPLER_BLOCK_COUNT)
+    {
+        count++;
+    }
+
+    sampler_block_t *block = &ring[head];
+
+    for (size_t i = 0; i < TIME_SIZE; i++)
+    {
+        block->data[i] = (uint8_t)(time_ms >> (8 * (TIME_SIZE - 1 - i)));
+    }
+    block->data[TIME_SIZE] = (uint8_t)((uint16_t)temp >> 8);
+    block->data[TIME_SIZE + 1] = (uint8_t)temp;
+    block->used = BLOCK_HEADER_SIZE;
+}
+
+static size_t write_varint(uint8_t *buf, uint32_t v)
+{
+    size_t len = 0;
+
+    while (v > VARINT_MASK)
+    {
+        buf[len++] = (uint8_t)(v & VARINT_MASK) | VARINT_MORE;
+        v >>= VARINT_SHIFT;
+    }
+    buf[len++] = (uint8_t)v;
+
+    return len;
+}
+
+/* Maps small negative and positive deltas to small unsigned values. */
+static inline uint32_t zigzag(int32_t v)
+{
+    return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31);
+}
+
+static uint64_t now_ms(void)
+{
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+
+    return (uint64_t)tv.tv_sec * 1000ULL + (uint64_t)tv.tv_usec / 1000ULL;
+}
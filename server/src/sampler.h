@@ -0,0 +1,68 @@
+#ifndef SAMPLER_H
+#define SAMPLER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * Samples are kept in a ring of fixed-size blocks. Each block starts with
+ * an absolute sample and continues with deltas to the previous sample:
+ *
+ *   | TIME ms (8, BE) | TEMP centi-°C (2, BE) | { DT ms (varint) | DTEMP (zigzag varint) }* |
+ *
+ * Varints are LEB128, 7 bits per byte with the low group first. When the
+ * ring is full the oldest block is overwritten.
+ */
+
+#ifndef SAMPLER_INTERVAL_MS
+#define SAMPLER_INTERVAL_MS 1000
+#endif
+#define SAMPLER_BLOCK_SIZE 128
+#define SAMPLER_BLOCK_COUNT 64
+#define SAMPLER_CHUNK_MAX (8 * (SAMPLER_BLOCK_SIZE + 1))
+
+typedef bool (*sampler_read_t)(float *temperature);
+
+/**
+ * @brief Called once per chunk by sampler_dump().
+ *
+ * @param index  Index of the chunk, from 0
+ * @param count  Number of chunks in the dump
+ * @param blocks Blocks in the chunk, each prefixed with its length (1 byte)
+ * @param len    Length of blocks in bytes
+ *
+ * @return true to continue with the next chunk, false to stop the dump
+ */
+typedef bool (*sampler_chunk_t)(uint16_t index, uint16_t count, const uint8_t *blocks, size_t len);
+
+/**
+ * @brief Start the sampler task.
+ *
+ * The task reads the temperature every SAMPLER_INTERVAL_MS and appends
+ * it to the ring together with the current time.
+ *
+ * @param read_temperature Function reading the temperature sensor
+ *
+ * @return true  If the task was created
+ * @return false Otherwise
+ */
+bool sampler_init(sampler_read_t read_temperature);
+
+/**
+ * @brief Hand the content of the ring, oldest block first, to a callback.
+ *
+ * Blocks are packed into chunks of at most chunk_size bytes, capped to
+ * SAMPLER_CHUNK_MAX. There is
+ * always at least one chunk, which is empty if nothing was sampled yet.
+ * Sampling waits until the dump is done.
+ *
+ * @param chunk      Callback receiving each chunk
+ * @param chunk_size Maximum chunk length, at least SAMPLER_BLOCK_SIZE + 1
+ *
+ * @return true  If every chunk was accepted by the callback
+ * @return false Otherwise
+ */
+bool sampler_dump(sampler_chunk_t chunk, size_t chunk_size);
+
+#endif
@@ -0,0 +1,114 @@
+#include <math.h>
+#include "telemetry.h"
+#include "session.h"
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+
+#define TELEMETRY_STACK_SIZE 4096
+#define TELEMETRY_PRIORITY 5
+#define CENTI_PER_DEGREE 100.0f
+
+typedef struct
+{
+    uint16_t interval_ms; // 0 while not subscribed
+    uint16_t threshold_centi;
+} telemetry_config_t;
+
+static QueueHandle_t config_queue = NULL;
+static telemetry_read_t read_sensor = NULL;
+
+static void telemetry_task(void *arg);
+static TickType_t interval_ticks(const telemetry_config_t *config);
+
+bool telemetry_init(telemetry_read_t read_temperature)
+{
+    bool status = false;
+    read_sensor = read_temperature;
+
+    // Length one: a new configuration replaces one the task has not seen yet
+    config_queue = xQueueCreate(1, sizeof(telemetry_config_t));
+
+    if (config_queue != NULL)
+    {
+        status = (pdPASS == xTaskCreate(telemetry_task, "telemetry", TELEMETRY_STACK_SIZE,
+                                        NULL, TELEMETRY_PRIORITY, NULL));
+    }
+
+    return status;
+}
+
+bool telemetry_subscribe(uint16_t interval_ms, uint16_t threshold_centi)
+{
+    telemetry_config_t config = {
+        .interval_ms = interval_ms,
+        .threshold_centi = threshold_centi};
+
+    return (interval_ms > 0) && (pdPASS == xQueueOverwrite(config_queue, &config));
+}
+
+void telemetry_unsubscribe(void)
+{
+    telemetry_config_t config = {0};
+
+    xQueueOverwrite(config_queue, &config);
+}
+
+static void telemetry_task(void *arg)
+{
+    (void)arg;
+
+    telemetry_config_t config = {0};
+    TickType_t next_sample = 0;
+    bool pushed = false;
+    float last_pushed = 0.0f;
+
+    while (true)
+    {
+        TickType_t wait = portMAX_DELAY;
+
+        if (config.interval_ms > 0)
+        {
+            TickType_t now = xTaskGetTickCount();
+            // Signed difference so a late sample is taken right away
+            wait = ((int32_t)(next_sample - now) > 0) ? (next_sample - now) : 0;
+        }
+
+        // The queue doubles as the sample timer, so a new configuration applies at once
+        if (pdPASS == xQueueReceive(config_queue, &config, wait))
+        {
+            next_sample = xTaskGetTickCount();
+            pushed = false;
+        }
+        else if (config.interval_ms > 0)
+        {
+            // Fixed schedule, so the rate does not drift with the time spent pushing
+            next_sample += interval_ticks(&config);
+
+            float temperature = 0.0f;
+            bool status = read_sensor(&temperature);
+
+            if (!pushed || !status ||
+                (fabsf(temperature - last_pushed) * CENTI_PER_DEGREE >= config.threshold_centi))
+            {
+                if (session_push_temperature(status, temperature))
+                {
+                    pushed = status;
+                    last_pushed = temperature;
+                }
+                else
+                {
+                    config.interval_ms = 0;
+                }
+            }
+        }
+    }
+}
+
+static TickType_t interval_ticks(const telemetry_config_t *config)
+{
+    TickType_t ticks = pdMS_TO_TICKS(config->interval_ms);
+
+    return (ticks > 0) ? ticks : 1;
+}
@@ -0,0 +1,44 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef bool (*telemetry_read_t)(float *temperature);
+
+/**
+ * @brief Start the telemetry task.
+ *
+ * The task stays idle until telemetry_subscribe() is called. Samples are
+ * pushed to the client with session_push_temperature().
+ *
+ * @param read_temperature Function reading the temperature sensor
+ *
+ * @return true  If the task was created
+ * @return false Otherwise
+ */
+bool telemetry_init(telemetry_read_t read_temperature);
+
+/**
+ * @brief Start or reconfigure the temperature subscription.
+ *
+ * A sample is taken every interval_ms and pushed if it differs from the
+ * last pushed sample by at least threshold_centi hundredths of a degree.
+ * The first sample and failed readings are always pushed. The
+ * subscription ends by itself once a push fails, e.g. after the session
+ * closes.
+ *
+ * @param interval_ms     Sample interval, rounded up to at least one tick
+ * @param threshold_centi Change threshold, 0 pushes every sample
+ *
+ * @return true  If the new configuration was handed to the task
+ * @return false Otherwise
+ */
+bool telemetry_subscribe(uint16_t interval_ms, uint16_t threshold_centi);
+
+/**
+ * @brief Stop pushing temperature samples.
+ */
+void telemetry_unsubscribe(void);
+
+#endif
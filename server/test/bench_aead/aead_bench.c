@@ -0,0 +1,204 @@
+#include <stdio.h>
+#include <string.h>
+#include "aead_bench.h"
+#include "session_crypto.h"
+
+#define MAX_PAYLOAD 1024
+#define DATA_AAD_SIZE 12 // session ID and sequence number
+#define HANDSHAKE_AAD_SIZE 8
+#define REPLY_AAD_SIZE 9 // random and chosen suite
+#define SHAPE_COUNT (sizeof(shapes) / sizeof(shapes[0]))
+#define SWEEP_COUNT (sizeof(sweep) / sizeof(sweep[0]))
+
+typedef struct
+{
+    const char *name;
+    uint16_t len;
+    uint8_t aad_len;
+} message_shape_t;
+
+typedef struct
+{
+    double encrypt;
+    double decrypt;
+} timing_t;
+
+static bool time_message(size_t len, size_t aad_len, timing_t *timing);
+static bool time_key_setup(session_suite_t suite, double *per_call);
+static bool run_suite(session_suite_t suite, const char *unit);
+static void print_winners(const char *label, const double *cost, size_t count);
+
+// Plaintext sizes of the messages built in session.c
+static const message_shape_t shapes[] = {
+    {"handshake 1", 45, HANDSHAKE_AAD_SIZE}, // session key, random and all suites
+    {"handshake 1 reply", 8, REPLY_AAD_SIZE},
+    {"handshake 2", 8, HANDSHAKE_AAD_SIZE},
+    {"GET_TEMP request", 9, DATA_AAD_SIZE},
+    {"GET_TEMP response", 13, DATA_AAD_SIZE},
+    {"TOGGLE_LED request", 9, DATA_AAD_SIZE},
+    {"TOGGLE_LED response", 10, DATA_AAD_SIZE},
+};
+
+static const uint16_t sweep[] = {0, 16, 32, 64, 128, 256, 512, MAX_PAYLOAD};
+
+static const uint8_t key_bytes[SESSION_CRYPTO_KEY_SIZE] = {
+    0x60, 0x3d, 0xeb, 0x10, 0x15, 0xca, 0x71, 0xbe, 0x2b, 0x73, 0xae, 0xf0, 0x85, 0x7d, 0x77, 0x81,
+    0x1f, 0x35, 0x2c, 0x07, 0x3b, 0x61, 0x08, 0xd7, 0x2d, 0x98, 0x10, 0xa3, 0x09, 0x14, 0xdf, 0xf4};
+
+static aead_bench_clock_t now;
+static uint32_t rounds;
+static session_crypto_ctx_t ctx;
+static uint8_t plaintext[MAX_PAYLOAD];
+static uint8_t cipher[MAX_PAYLOAD + SESSION_CRYPTO_TAG_SIZE];
+static uint8_t decrypted[MAX_PAYLOAD];
+// Encrypt plus decrypt of every suite, indexed by suite identifier, to pick the winners
+static double shape_cost[SESSION_SUITE_COUNT + 1][SHAPE_COUNT];
+static double sweep_cost[SESSION_SUITE_COUNT + 1][SWEEP_COUNT];
+
+static bool time_message(size_t len, size_t aad_len, timing_t *timing)
+{
+    bool status = true;
+    uint8_t iv[SESSION_CRYPTO_IV_SIZE] = {0};
+    uint8_t aad[DATA_AAD_SIZE] = {0};
+
+    uint64_t start = now();
+    for (uint32_t i = 0; status && (i < rounds); i++)
+    {
+        // A fresh nonce per call, as the session derives from its counter
+        iv[SESSION_CRYPTO_IV_SIZE - 1] = (uint8_t)i;
+        iv[SESSION_CRYPTO_IV_SIZE - 2] = (uint8_t)(i >> 8);
+        status = session_crypto_encrypt(&ctx, iv, aad, aad_len, plaintext, len, cipher);
+    }
+    timing->encrypt = (double)(now() - start) / rounds;
+
+    start = now();
+    for (uint32_t i = 0; status && (i < rounds); i++)
+    {
+        status = session_crypto_decrypt(&ctx, iv, aad, aad_len, cipher, len + SESSION_CRYPTO_TAG_SIZE, decrypted);
+    }
+    timing->decrypt = (double)(now() - start) / rounds;
+
+    return status && (0 == memcmp(plaintext, decrypted, len));
+}
+
+static bool time_key_setup(session_suite_t suite, double *per_call)
+{
+    bool status = true;
+    session_crypto_ctx_t setup;
+
+    session_crypto_init(&setup);
+    uint64_t start = now();
+    for (uint32_t i = 0; status && (i < rounds); i++)
+    {
+        status = session_crypto_set_key(&setup, suite, key_bytes);
+    }
+    *per_call = (double)(now() - start) / rounds;
+    session_crypto_clear(&setup);
+
+    return status;
+}
+
+static bool run_suite(session_suite_t suite, const char *unit)
+{
+    bool status = false;
+    double key_setup = 0;
+    timing_t timing;
+    timing_t empty = {0};
+    timing_t largest = {0};
+
+    if (time_key_setup(suite, &key_setup) && session_crypto_set_key(&ctx, suite, key_bytes))
+    {
+        status = true;
+        printf("\n%s, %s per call\n", session_crypto_suite_name(suite), unit);
+        printf("%-22s: %10.1f\n", "context key setup", key_setup);
+
+        printf("%-22s  %10s %10s\n", "message", "encrypt", "decrypt");
+        for (size_t i = 0; status && (i < SHAPE_COUNT); i++)
+        {
+            status = time_message(shapes[i].len, shapes[i].aad_len, &timing);
+            printf("%-22s: %10.1f %10.1f\n", shapes[i].name, timing.encrypt, timing.decrypt);
+            shape_cost[suite][i] = timing.encrypt + timing.decrypt;
+        }
+
+        printf("%-22s  %10s %10s %10s\n", "payload bytes", "encrypt", "decrypt", "enc/byte");
+        for (size_t i = 0; status && (i < SWEEP_COUNT); i++)
+        {
+            status = time_message(sweep[i], DATA_AAD_SIZE, &timing);
+            printf("%22u: %10.1f %10.1f %10.2f\n", (unsigned)sweep[i], timing.encrypt, timing.decrypt,
+                   (0 == sweep[i]) ? 0.0 : timing.encrypt / sweep[i]);
+            sweep_cost[suite][i] = timing.encrypt + timing.decrypt;
+            empty = (0 == sweep[i]) ? timing : empty;
+            largest = timing;
+        }
+
+        // The empty message is the fixed cost, the slope up to the largest one the cost per byte
+        printf("%-22s: %10.1f %10.1f\n", "per-call overhead", empty.encrypt, empty.decrypt);
+        printf("%-22s: %10.2f %10.2f\n", "per byte", (largest.encrypt - empty.encrypt) / MAX_PAYLOAD,
+               (largest.decrypt - empty.decrypt) / MAX_PAYLOAD);
+    }
+    session_crypto_clear(&ctx);
+
+    return status;
+}
+
+/* cost is a column of shape_cost or sweep_cost, stepping over whole rows. */
+static void print_winners(const char *label, const double *cost, size_t count)
+{
+    session_suite_t best = SESSION_SUITE_NONE;
+
+    for (int suite = 1; suite <= SESSION_SUITE_COUNT; suite++)
+    {
+        double value = cost[suite * count];
+
+        if ((NULL != session_crypto_suite_name((session_suite_t)suite)) &&
+            ((SESSION_SUITE_NONE == best) || (value < cost[best * count])))
+        {
+            best = (session_suite_t)suite;
+        }
+    }
+
+    printf("%-22s: %-18s %10.1f\n", label, session_crypto_suite_name(best), cost[best * count]);
+}
+
+bool aead_bench_run(aead_bench_clock_t clock, const char *unit, uint32_t iterations)
+{
+    bool status = true;
+    char label[24];
+
+    now = clock;
+    rounds = iterations;
+    for (size_t i = 0; i < sizeof(plaintext); i++)
+    {
+        plaintext[i] = (uint8_t)(i * 31 + 7);
+    }
+
+    session_crypto_init(&ctx);
+    for (int suite = 1; status && (suite <= SESSION_SUITE_COUNT); suite++)
+    {
+        // Suites left out of the mbedTLS configuration are skipped
+        if (NULL != session_crypto_suite_name((session_suite_t)suite))
+        {
+            status = run_suite((session_suite_t)suite, unit);
+        }
+    }
+
+    if (status)
+    {
+        printf("\nfastest, encrypt + decrypt in %s\n", unit);
+        for (size_t i = 0; i < SHAPE_COUNT; i++)
+        {
+            print_winners(shapes[i].name, &shape_cost[0][i], SHAPE_COUNT);
+        }
+        for (size_t i = 0; i < SWEEP_COUNT; i++)
+        {
+            (void)snprintf(label, sizeof(label), "%u bytes", (unsigned)sweep[i]);
+            print_winners(label, &sweep_cost[0][i], SWEEP_COUNT);
+        }
+    }
+    else
+    {
+        printf("AEAD benchmark failed\n");
+    }
+
+    return status;
+}
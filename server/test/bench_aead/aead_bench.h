@@ -0,0 +1,32 @@
+#ifndef AEAD_BENCH_H
+#define AEAD_BENCH_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * Benchmark of the session AEAD path, shared by the host build in
+ * server/bench and the on-target PlatformIO test in this directory.
+ * Times are read from the clock given by the caller, in its own unit,
+ * cycles on the target and nanoseconds on the host.
+ */
+
+typedef uint64_t (*aead_bench_clock_t)(void);
+
+/**
+ * @brief Time key setup, the session message shapes and a sweep of payload sizes.
+ *
+ * Every suite built into session_crypto is timed, then the fastest one is
+ * listed per message shape and payload size. psa_crypto_init() must have
+ * been called. Results are printed to stdout.
+ *
+ * @param clock      Monotonic clock, read around each batch of calls
+ * @param unit       Unit of the clock, printed with the results
+ * @param iterations Calls per measurement
+ *
+ * @return true  If every call succeeded and every message decrypted to its plaintext
+ * @return false Otherwise
+ */
+bool aead_bench_run(aead_bench_clock_t clock, const char *unit, uint32_t iterations);
+
+#endif
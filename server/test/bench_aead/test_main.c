@@ -0,0 +1,48 @@
+#include <unity.h>
+#include <psa/crypto.h>
+#include "esp_cpu.h"
+#include "aead_bench.h"
+
+/*
+ * On-target run of the AEAD benchmark: pio test -f bench_aead
+ * Times are CPU cycles, so they read directly as cycles per call and per byte.
+ */
+
+#define ITERATIONS 200
+
+static uint64_t cycles(void);
+static void test_aead_bench(void);
+
+// The cycle counter wraps after a few seconds, it is extended on every read
+static uint64_t cycles(void)
+{
+    static uint64_t total = 0;
+    static uint32_t last = 0;
+    uint32_t count = esp_cpu_get_cycle_count();
+
+    total += (uint32_t)(count - last);
+    last = count;
+
+    return total;
+}
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+static void test_aead_bench(void)
+{
+    TEST_ASSERT_EQUAL(PSA_SUCCESS, psa_crypto_init());
+    TEST_ASSERT_TRUE(aead_bench_run(cycles, "cycles", ITERATIONS));
+}
+
+void app_main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_aead_bench);
+    UNITY_END();
+}